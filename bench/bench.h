@@ -0,0 +1,27 @@
+#pragma once
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+// Zero-dependency benchmark helpers, in the same spirit as tests/harness.h:
+// a stopwatch and a uniform one-line result format so runs are easy to diff.
+// Build with -DCMAKE_BUILD_TYPE=Release before trusting any number.
+
+namespace bench {
+
+class Stopwatch {
+public:
+    Stopwatch() : start_(std::chrono::steady_clock::now()) {}
+    double seconds() const {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+    }
+
+private:
+    std::chrono::steady_clock::time_point start_;
+};
+
+inline void report(const std::string& name, double value, const char* unit) {
+    std::printf("%-48s %14.3f %s\n", name.c_str(), value, unit);
+}
+
+} // namespace bench
@@ -0,0 +1,224 @@
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <malloc.h>
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "bench.h"
+#include "core/TextSnapshot.h"
+#include "spell/Completer.h"
+#include "spell/Dawg.h"
+#include "spell/DeletionIndex.h"
+#include "spell/Dictionary.h"
+#include "spell/Suggester.h"
+
+// Dictionary footprint, load time and lookup cost: the flat arena + open
+// addressing table and the DAWG vs. the unordered_set<string> the table
+// replaced (reproduced below), plus suggest() on the table, the DAWG and
+// the deletion index, and prefix completion. Footprint is measured as the
+// allocator's in-use bytes. Also times mapping the same table back in from
+// a dictionary.bin, and lookups on it.
+//
+// Usage: bench_dictionary [dictionary]   (default dictionary.txt; run from the repository root)
+
+using namespace editor;
+
+namespace {
+
+// The previous implementation, kept here as the baseline.
+class SetDictionary {
+public:
+    void loadFromFile(const std::string& path) {
+        std::ifstream file(path);
+        std::string word;
+        while (file >> word) words_.insert(Dictionary::normalize(word));
+    }
+    bool contains(const std::string& word) const { return words_.count(Dictionary::normalize(word)) > 0; }
+    size_t size() const { return words_.size(); }
+
+private:
+    std::unordered_set<std::string> words_;
+};
+
+size_t heapInUse() {
+    return mallinfo2().uordblks;
+}
+
+std::vector<std::string> readWords(const std::string& path) {
+    std::ifstream file(path);
+    std::vector<std::string> words;
+    std::string w;
+    while (file >> w) words.push_back(w);
+    return words;
+}
+
+template <typename Dict>
+void run(const char* name, const std::string& path, const std::vector<std::string>& probes) {
+    size_t before = heapInUse();
+    bench::Stopwatch load;
+    auto* dict = new Dict;
+    dict->loadFromFile(path);
+    double loadMs = load.seconds() * 1e3;
+    size_t bytes = heapInUse() - before;
+
+    size_t found = 0;
+    bench::Stopwatch sw;
+    for (const std::string& p : probes) found += dict->contains(p);
+    double ns = sw.seconds() * 1e9 / probes.size();
+
+    bench::report(std::string(name) + " load", loadMs, "ms");
+    bench::report(std::string(name) + " heap in use", bytes / 1024.0, "KiB");
+    bench::report(std::string(name) + " contains (~50% hits)", ns, "ns/op");
+    if (found == 0) std::printf("(no hits?)\n");
+    delete dict;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string path = argc > 1 ? argv[1] : "dictionary.txt";
+    std::vector<std::string> words = readWords(path);
+    if (words.empty()) {
+        std::printf("dictionary not found - run from the repository root\n");
+        return 1;
+    }
+    // Half real words (mixed case), half one-letter typos of them.
+    std::mt19937 rng(7);
+    std::vector<std::string> probes;
+    for (int i = 0; i < 1000000; ++i) {
+        std::string w = words[rng() % words.size()];
+        if (i % 2) w[rng() % w.size()] = 'q';
+        else w[0] = static_cast<char>(std::toupper(static_cast<unsigned char>(w[0])));
+        probes.push_back(std::move(w));
+    }
+
+    std::printf("%zu words\n", words.size());
+    run<Dictionary>("flat table:", path, probes);
+    run<SetDictionary>("unordered_set:", path, probes);
+    run<Dawg>("dawg:", path, probes);
+    {
+        Dawg dawg;
+        dawg.loadFromFile(path);
+        bench::report("dawg: bytesUsed()", dawg.bytesUsed() / 1024.0, "KiB");
+        size_t hits = 0;
+        bench::Stopwatch sw;
+        for (const std::string& p : probes) hits += dawg.hasPrefix(std::string_view(p).substr(0, (p.size() + 1) / 2));
+        bench::report("dawg: hasPrefix (first half of each probe)", sw.seconds() * 1e9 / probes.size(), "ns/op");
+        if (hits == 0) std::printf("(no prefix hits?)\n");
+
+        // Suggestions for typos: brute-force candidates against the flat
+        // table vs. the DAWG walk that prunes dead prefixes.
+        Dictionary table;
+        table.loadFromFile(path);
+        std::atomic<bool> cancelled{false};
+        std::vector<std::string> typos;
+        for (size_t i = 1; typos.size() < 5000; i += 2) typos.push_back(probes[i]);
+        size_t a = 0, b = 0;
+        bench::Stopwatch brute;
+        for (const std::string& t : typos) a += suggest(table, t, cancelled).suggestions.size();
+        double bruteUs = brute.seconds() * 1e6 / typos.size();
+        bench::Stopwatch pruned;
+        for (const std::string& t : typos) b += suggest(dawg, t, cancelled).suggestions.size();
+        double prunedUs = pruned.seconds() * 1e6 / typos.size();
+        bench::report("suggest: flat table, brute force", bruteUs, "us/word");
+        bench::report("suggest: dawg, pruned walk", prunedUs, "us/word");
+        if (a != b) std::printf("(suggestion counts differ: %zu vs %zu)\n", a, b);
+
+        // The deletion index: distance 2 instead of 1, from a prebuilt index.
+        DeletionIndex index;
+        bench::Stopwatch build;
+        index.build(words);
+        bench::report("deletion index: build", build.seconds() * 1e3, "ms");
+        bench::report("deletion index: bytesUsed()", index.bytesUsed() / 1024.0, "KiB");
+        size_t within2 = 0;
+        bench::Stopwatch lookup;
+        for (const std::string& t : typos) within2 += suggest(index, t, cancelled).suggestions.size();
+        bench::report("suggest: deletion index, distance <= 2", lookup.seconds() * 1e6 / typos.size(), "us/word");
+        // Two typos: the one-letter edits above can't reach these at all.
+        std::vector<std::string> doubled;
+        for (const std::string& t : typos) {
+            if (t.size() > 3) doubled.push_back(t.substr(0, t.size() / 2) + t.substr(t.size() / 2 + 1));
+        }
+        auto unanswered = [&](auto& source) {
+            return std::count_if(doubled.begin(), doubled.end(), [&](const std::string& t) {
+                return suggest(source, t, cancelled).suggestions.empty();
+            });
+        };
+        std::printf("two-typo words with no suggestion: dawg %zu of %zu, deletion index %zu of %zu\n",
+                    static_cast<size_t>(unanswered(dawg)), doubled.size(), static_cast<size_t>(unanswered(index)),
+                    doubled.size());
+        if (within2 < b) std::printf("(index found fewer suggestions than the dawg?)\n");
+    }
+    {
+        // Completion as the editor runs it: against the whole dictionary
+        // plus the words of a 100k-word document, for 1-3 letter prefixes
+        // (the shortest match the most words, so they are the slow case).
+        Completer completer;
+        bench::Stopwatch build;
+        completer.build(words);
+        bench::report("completer: build", build.seconds() * 1e3, "ms");
+        bench::report("completer: bytesUsed()", completer.bytesUsed() / 1024.0, "KiB");
+        std::vector<std::string> lines;
+        for (size_t i = 0; i < 10000; ++i) {
+            std::string line;
+            for (int k = 0; k < 10; ++k) line += words[rng() % words.size()] + " ";
+            lines.push_back(std::move(line));
+        }
+        std::atomic<bool> cancelled{false};
+        bench::Stopwatch collect;
+        BufferWords doc = BufferWords::collect(LineVectorSnapshot(lines), cancelled);
+        bench::report("completer: collect 100k-word document", collect.seconds() * 1e3, "ms");
+        for (size_t len = 1; len <= 3; ++len) {
+            size_t n = 0, offered = 0;
+            double worst = 0;
+            bench::Stopwatch all;
+            for (size_t i = 0; i < 2000; ++i) {
+                const std::string& w = words[rng() % words.size()];
+                if (w.size() <= len) continue;
+                bench::Stopwatch one;
+                offered += completer.complete(std::string_view(w).substr(0, len), 6, &doc).size();
+                worst = std::max(worst, one.seconds() * 1e6);
+                ++n;
+            }
+            std::string name = "completer: " + std::to_string(len) + "-letter prefix";
+            bench::report(name + ", mean", all.seconds() * 1e6 / n, "us/query");
+            bench::report(name + ", worst", worst, "us/query");
+            if (offered == 0) std::printf("(no completions?)\n");
+        }
+    }
+    Dictionary d;
+    d.loadFromFile(path);
+    bench::report("flat table: bytesUsed()", d.bytesUsed() / 1024.0, "KiB");
+
+    const std::string bin = "bench_dictionary.bin";
+    if (!d.writeBinary(bin, *Dictionary::stampOf(path))) {
+        std::printf("could not write %s\n", bin.c_str());
+        return 1;
+    }
+    // Best of several: the first also pays for faulting the file into the
+    // page cache, which a second editor process never does.
+    double best = 1e9;
+    for (int i = 0; i < 20; ++i) {
+        Dictionary mapped;
+        bench::Stopwatch sw;
+        mapped.load(path, {bin});
+        best = std::min(best, sw.seconds() * 1e3);
+        if (!mapped.mapped()) std::printf("(binary not used?)\n");
+    }
+    bench::report("binary: load (mmap + validate)", best, "ms");
+    Dictionary mapped;
+    mapped.loadBinary(bin);
+    size_t found = 0;
+    bench::Stopwatch sw;
+    for (const std::string& p : probes) found += mapped.contains(p);
+    bench::report("binary: contains (~50% hits)", sw.seconds() * 1e9 / probes.size(), "ns/op");
+    if (found == 0) std::printf("(no hits?)\n");
+    std::remove(bin.c_str());
+    return 0;
+}
@@ -0,0 +1,100 @@
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bench.h"
+#include "concurrent/EventQueue.h"
+
+// Push/drain throughput with 1-16 producers and one draining consumer: the
+// lock-free EventQueue vs. the mutex + std::queue + drainAll() vector it
+// replaced (reproduced below), plus the cost of draining an empty queue,
+// which is what every idle loop iteration pays.
+//
+// Usage: bench_eventqueue [eventsPerProducer]   (default 200000)
+
+using namespace editor;
+
+namespace {
+
+// The previous implementation, kept here as the baseline.
+class MutexQueue {
+public:
+    void push(Event e) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.push(std::move(e));
+    }
+    template <typename F>
+    size_t drain(F&& visit) {
+        std::vector<Event> out;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            out.reserve(queue_.size());
+            while (!queue_.empty()) {
+                out.push_back(std::move(queue_.front()));
+                queue_.pop();
+            }
+        }
+        for (Event& e : out) visit(e);
+        return out.size();
+    }
+
+private:
+    std::queue<Event> queue_;
+    std::mutex mutex_;
+};
+
+template <typename Queue>
+double throughput(int producers, int perProducer) {
+    Queue queue;
+    std::atomic<bool> start{false};
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&] {
+            while (!start.load()) std::this_thread::yield();
+            for (int i = 0; i < perProducer; ++i) queue.push(DictionaryLoadedEvent{static_cast<size_t>(i)});
+        });
+    }
+    long long total = static_cast<long long>(producers) * perProducer;
+    long long received = 0;
+    size_t sum = 0;
+    bench::Stopwatch sw;
+    start = true;
+    while (received < total) {
+        size_t n = queue.drain([&sum](Event& e) { sum += std::get<DictionaryLoadedEvent>(e).wordCount; });
+        if (n == 0) std::this_thread::yield();
+        received += static_cast<long long>(n);
+    }
+    double seconds = sw.seconds();
+    for (auto& t : threads) t.join();
+    if (sum == 0) std::printf("(empty)\n");
+    return total / seconds / 1e6;
+}
+
+template <typename Queue>
+double emptyDrainNs() {
+    Queue queue;
+    const int rounds = 1000000;
+    size_t n = 0;
+    bench::Stopwatch sw;
+    for (int i = 0; i < rounds; ++i) n += queue.drain([](Event&) {});
+    if (n != 0) std::printf("(unexpected events)\n");
+    return sw.seconds() * 1e9 / rounds;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int perProducer = argc > 1 ? std::atoi(argv[1]) : 200000;
+    for (int producers : {1, 2, 4, 8, 16}) {
+        std::string suffix = " (" + std::to_string(producers) + " producers)";
+        bench::report("lock-free push/drain" + suffix, throughput<EventQueue>(producers, perProducer), "M events/s");
+        bench::report("mutex push/drainAll" + suffix, throughput<MutexQueue>(producers, perProducer), "M events/s");
+    }
+    bench::report("lock-free drain, empty queue", emptyDrainNs<EventQueue>(), "ns/op");
+    bench::report("mutex drainAll, empty queue", emptyDrainNs<MutexQueue>(), "ns/op");
+    return 0;
+}
@@ -0,0 +1,196 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <future>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "bench.h"
+#include "core/Newlines.h"
+#include "core/TextBuffer.h"
+#include "io/FileIO.h"
+#include "io/ParallelLoad.h"
+
+// Opening a large file: the mmap loader handing the mapping to the piece
+// table vs. the loader it replaced (read into a string, substr every line,
+// copy the lines into the load event, join them again in the piece table),
+// reproduced below. Each runs in a child process so its peak RSS can be
+// read back on its own. Also the newline count the load is bound by, in
+// GB/s: plain loop, memchr, and the vectorized countNewlines(). Then the
+// parallel loader with 1, 2, 4, ... bulk workers, up to one per core, and
+// the streaming loader's time to the first screen. Last, large-file mode
+// (StorageKind::LargeFile): open, edit and save, with the memory that is
+// not the file's own pages - peak RSS counts the mapping, which the kernel
+// can drop and refault, so each child also reports its anonymous RSS.
+//
+// Usage: bench_load [MiB]   (default 512; the file is written to the working directory)
+
+using namespace editor;
+
+namespace {
+const char* kPath = "bench_load.tmp";
+
+std::vector<std::string> legacyLoad(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    std::vector<std::string> lines;
+    size_t start = 0;
+    for (size_t i = 0; i < content.size(); ++i) {
+        if (content[i] == '\n') {
+            lines.push_back(content.substr(start, i - start));
+            start = i + 1;
+        }
+    }
+    if (start < content.size()) lines.push_back(content.substr(start));
+    return lines;
+}
+
+// Resident memory not backed by a file, in bytes (Linux: RssAnon).
+size_t anonymousRss() {
+    std::ifstream status("/proc/self/status");
+    std::string key;
+    size_t kib = 0;
+    while (status >> key) {
+        if (key == "RssAnon:") {
+            status >> kib;
+            break;
+        }
+    }
+    return kib * 1024;
+}
+
+// Runs `load` in a child and reports its time, throughput and peak and
+// anonymous RSS.
+template <typename F>
+void inChild(const std::string& name, size_t bytes, F&& load) {
+    std::fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0) {
+        bench::Stopwatch sw;
+        Row lines = load();
+        double s = sw.seconds();
+        bench::report(name + ": open", s * 1e3, "ms");
+        bench::report(name + ": throughput", bytes / s / 1e9, "GB/s");
+        if (lines <= 1) std::printf("(no lines?)\n");
+        bench::report(name + ": anonymous RSS", anonymousRss() / 1048576.0, "MiB");
+        std::fflush(stdout);
+        std::_Exit(0);
+    }
+    int status = 0;
+    rusage usage{};
+    wait4(pid, &status, 0, &usage);
+    bench::report(name + ": peak RSS / file size", usage.ru_maxrss * 1024.0 / bytes, "x");
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t mib = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 512;
+    size_t bytes = mib << 20;
+    {
+        std::ofstream out(kPath, std::ios::binary);
+        std::string line;
+        for (size_t written = 0, i = 0; written < bytes; written += line.size(), ++i) {
+            line = "2024-01-01 12:00:00.000 INFO request " + std::to_string(i) +
+                   " completed in 12ms status=200 path=/api/v1/items\n";
+            out << line;
+        }
+    }
+    LoadResult warm = loadFile(kPath); // into the page cache, so both runs start warm
+    bytes = warm.text.size + 1;
+    std::printf("%.0f MiB, %zu lines\n", bytes / 1048576.0, countNewlines(warm.text.data.get(), warm.text.size) + 1);
+
+    const char* data = warm.text.data.get();
+    size_t len = warm.text.size;
+    auto rate = [&](const char* name, auto&& count) {
+        size_t n = 0;
+        bench::Stopwatch sw;
+        for (int i = 0; i < 5; ++i) n += count();
+        bench::report(std::string("count newlines: ") + name, 5.0 * len / sw.seconds() / 1e9, "GB/s");
+        return n / 5;
+    };
+    size_t a = rate("plain loop", [&] { return countNewlinesScalar(data, len); });
+    size_t b = rate("memchr", [&] {
+        size_t n = 0;
+        for (const char* p = data; (p = static_cast<const char*>(std::memchr(p, '\n', data + len - p))); ++p) ++n;
+        return n;
+    });
+    size_t c = rate("countNewlines (vectorized)", [&] { return countNewlines(data, len); });
+    if (a != b || a != c) std::printf("(counts differ: %zu %zu %zu)\n", a, b, c);
+    warm = LoadResult{};
+
+    inChild("legacy loader", bytes, [] {
+        std::vector<std::string> lines = legacyLoad(kPath);
+        std::vector<std::string> event = lines; // LoadCompleteEvent{r.lines}
+        TextBuffer buf;
+        buf.loadLines(event); // doc_.loadLines(e.lines)
+        return buf.lineCount();
+    });
+    inChild("mmap loader", bytes, [] {
+        LoadResult r = loadFile(kPath);
+        TextBuffer buf;
+        buf.loadText(std::move(r.text));
+        return buf.lineCount();
+    });
+    unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned workers = 1;; workers = std::min(workers * 2, cores)) {
+        inChild("parallel loader, " + std::to_string(workers) + " worker(s)", bytes, [workers] {
+            ThreadPool pool(workers + 1, workers);
+            std::promise<LoadResult> done;
+            loadFileParallel(pool, Lane::IO, kPath, [&done](LoadResult r) { done.set_value(std::move(r)); });
+            LoadResult r = done.get_future().get();
+            TextBuffer buf;
+            buf.loadText(std::move(r.text));
+            return buf.lineCount();
+        });
+        if (workers == cores) break;
+    }
+    inChild("streaming loader", bytes, [] {
+        // Time to the first screen: openFile() plus the first chunk's count,
+        // then the document being usable, then the rest streaming in.
+        ThreadPool pool;
+        std::promise<void> finished;
+        TextBuffer buf;
+        std::mutex m;
+        bench::Stopwatch sw;
+        streamFileParallel(
+            pool, Lane::IO, kPath,
+            [&](LoadResult r, size_t) {
+                std::lock_guard<std::mutex> lock(m);
+                buf.loadText(std::move(r.text));
+                if (buf.line(0).empty()) std::printf("(empty first line?)\n");
+                bench::report("streaming loader: first screen", sw.seconds() * 1e3, "ms");
+            },
+            [&](LoadChunk c) {
+                std::lock_guard<std::mutex> lock(m);
+                buf.appendText(std::move(c.text));
+                if (c.loaded == c.total) finished.set_value();
+            });
+        finished.get_future().get();
+        return buf.lineCount();
+    });
+    inChild("large-file mode", bytes, [] {
+        // The mapping and a sparse index; the edits in their own pieces; the
+        // save streamed run by run from the snapshot.
+        LoadResult r = loadFile(kPath);
+        TextBuffer buf(StorageKind::LargeFile);
+        buf.loadText(std::move(r.text));
+        Row lines = buf.lineCount();
+        for (Row row = 0; row < lines; row += lines / 64) buf.insertText({row, 0}, "edited ");
+        bench::Stopwatch sw;
+        std::string savePath = std::string(kPath) + ".saved";
+        if (!saveFile(savePath, *buf.snapshot(), r.trailingNewline).success) std::printf("(save failed)\n");
+        bench::report("large-file mode: save", sw.seconds() * 1e3, "ms");
+        std::remove(savePath.c_str());
+        return lines;
+    });
+    std::remove(kPath);
+    return 0;
+}
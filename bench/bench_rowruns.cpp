@@ -0,0 +1,62 @@
+#include <cstdlib>
+#include <vector>
+
+#include "bench.h"
+#include "ui/RowRuns.h"
+
+// Curses calls per full-screen repaint, per-character attribute toggling
+// (the old drawBuffer) vs. one attrset+addnstr per style run, plus the cost
+// of computing the runs themselves. ncurses is not involved: the call counts
+// follow directly from the run layout.
+//
+// Usage: bench_rowruns [rows] [cols]   (default 60 x 300)
+
+using namespace editor;
+
+int main(int argc, char** argv) {
+    int rows = argc > 1 ? std::atoi(argv[1]) : 60;
+    int cols = argc > 2 ? std::atoi(argv[2]) : 300;
+
+    // A misspelled word every 40 columns and a selection across the middle
+    // third of the screen.
+    std::vector<MisspelledSpan> spans;
+    for (int r = 0; r < rows; ++r) {
+        for (int c = 7; c + 6 <= cols; c += 40) spans.push_back({r, c, c + 6});
+    }
+    MisspellingIndex index(std::move(spans));
+    int selFirst = rows / 3, selLast = 2 * rows / 3;
+
+    auto selectionOn = [&](int r, int& selStart, int& selEnd) {
+        selStart = selEnd = 0;
+        if (r < selFirst || r > selLast) return;
+        selStart = r == selFirst ? cols / 2 : 0;
+        selEnd = r == selLast ? cols / 4 : cols;
+    };
+
+    std::vector<StyleRun> runs;
+    long long runCount = 0;
+    const int frames = 2000;
+    bench::Stopwatch sw;
+    for (int f = 0; f < frames; ++f) {
+        auto [span, spansEnd] = index.rows(0, rows);
+        runCount = 0;
+        for (int r = 0; r < rows; ++r) {
+            int selStart, selEnd;
+            selectionOn(r, selStart, selEnd);
+            buildRuns(r, cols, selStart, selEnd, span, spansEnd, runs);
+            runCount += static_cast<long long>(runs.size());
+        }
+    }
+    double usPerFrame = sw.seconds() * 1e6 / frames;
+
+    // Old: move + clrtoeol per row, attron/mvaddch/attroff per cell.
+    // New: move + attrset + clrtoeol per row, attrset/addnstr per run.
+    long long before = static_cast<long long>(rows) * (2 + 3LL * cols);
+    long long after = 3LL * rows + 2 * runCount;
+
+    std::printf("%d x %d frame, %lld runs\n", rows, cols, runCount);
+    bench::report("curses calls per frame (per char)", static_cast<double>(before), "calls");
+    bench::report("curses calls per frame (per run)", static_cast<double>(after), "calls");
+    bench::report("build runs for a frame", usPerFrame, "us");
+    return 0;
+}
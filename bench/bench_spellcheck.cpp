@@ -0,0 +1,99 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bench.h"
+#include "concurrent/Snapshot.h"
+#include "spell/Dictionary.h"
+#include "spell/ParallelScan.h"
+#include "spell/SpellChecker.h"
+
+// Full-document spell scan over a generated file - sequential, and chunked
+// across 1..8 bulk workers - and how quickly a scan gives up its worker
+// once cancelled. Scaling is bounded by the machine's core count.
+//
+// Usage: bench_spellcheck [lineCount] [dictionary]   (default 500000, dictionary.txt)
+// Run from the repository root so dictionary.txt is found.
+
+using namespace editor;
+
+namespace {
+
+std::vector<std::string> makeLines(int count) {
+    const char* words[] = {"the", "quick", "brown", "fox", "jumps", "over", "lazy", "dog", "teh", "recieve",
+                           "editor", "buffer", "snapshot", "thread", "wrold", "spelling"};
+    std::vector<std::string> lines;
+    lines.reserve(count);
+    unsigned seed = 1;
+    for (int i = 0; i < count; ++i) {
+        std::string line;
+        for (int w = 0; w < 12; ++w) {
+            seed = seed * 1103515245u + 12345u;
+            line += words[(seed >> 16) % 16];
+            line += ' ';
+        }
+        lines.push_back(std::move(line));
+    }
+    return lines;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int count = argc > 1 ? std::atoi(argv[1]) : 500000;
+    Dictionary dict;
+    dict.loadFromFile(argc > 2 ? argv[2] : "dictionary.txt");
+    if (dict.size() == 0) {
+        std::printf("dictionary not found - run from the repository root\n");
+        return 1;
+    }
+    BufferSnapshot snap = makeSnapshot(makeLines(count));
+    std::printf("%d lines, %zu dictionary words\n", count, dict.size());
+
+    {
+        std::atomic<bool> never{false};
+        bench::Stopwatch sw;
+        auto spans = scanBuffer(*snap, dict, never);
+        bench::report("full scan", sw.seconds() * 1e3, "ms");
+        if (spans.empty()) std::printf("(no misspellings?)\n");
+    }
+
+    for (size_t workers : {1, 2, 4, 8}) {
+        ThreadPool pool(workers + 1); // as the editor sizes it: +1 kept for interactive work
+        std::promise<size_t> found;
+        bench::Stopwatch sw;
+        scanRowsParallel(pool, Lane::Background, snap, dict, {{0, count}}, std::make_shared<std::atomic<bool>>(false),
+                         [&found](std::vector<MisspelledSpan> spans) { found.set_value(spans.size()); });
+        size_t n = found.get_future().get();
+        bench::report("parallel scan, " + std::to_string(workers) + " bulk workers", sw.seconds() * 1e3, "ms");
+        if (n == 0) std::printf("(no misspellings?)\n");
+    }
+    std::printf("(%u hardware threads)\n", std::thread::hardware_concurrency());
+
+    const int rounds = 50;
+    double worstMs = 0, totalMs = 0;
+    for (int i = 0; i < rounds; ++i) {
+        std::atomic<bool> cancelled{false};
+        std::chrono::steady_clock::time_point returned;
+        std::thread scanner([&] {
+            scanBuffer(*snap, dict, cancelled);
+            returned = std::chrono::steady_clock::now();
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(2 + i % 7));
+        auto tripped = std::chrono::steady_clock::now();
+        cancelled = true;
+        scanner.join();
+        double ms = std::chrono::duration<double, std::milli>(returned - tripped).count();
+        totalMs += ms;
+        worstMs = std::max(worstMs, ms);
+    }
+    bench::report("cancel -> scan returns, mean", totalMs / rounds, "ms");
+    bench::report("cancel -> scan returns, worst", worstMs, "ms");
+    return 0;
+}
@@ -0,0 +1,105 @@
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "bench.h"
+#include "core/TextBuffer.h"
+
+// Edit latency near the top of a large file, and the cost of taking and
+// walking a snapshot, piece table vs. the original vector<string> backend.
+//
+// Usage: bench_textbuffer [lineCount]   (default 500000 lines of ~80 bytes)
+
+using namespace editor;
+
+namespace {
+
+std::vector<std::string> makeLines(int count) {
+    std::vector<std::string> lines;
+    lines.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        lines.push_back("2024-01-01 12:00:00.000 INFO request " + std::to_string(i) +
+                        " completed in 12ms status=200 path=/api/v1/items");
+    }
+    return lines;
+}
+
+void run(const char* name, StorageKind kind, const std::vector<std::string>& lines) {
+    TextBuffer buf(kind);
+    {
+        bench::Stopwatch sw;
+        buf.loadLines(lines);
+        bench::report(std::string(name) + " load", sw.seconds() * 1e3, "ms");
+    }
+
+    const int typed = 20000;
+    {
+        bench::Stopwatch sw;
+        Position at{5, 10};
+        for (int i = 0; i < typed; ++i) at = buf.insertText(at, "x");
+        bench::report(std::string(name) + " type char near top", sw.seconds() * 1e6 / typed, "us/op");
+    }
+
+    const int newlines = 2000;
+    {
+        bench::Stopwatch sw;
+        for (int i = 0; i < newlines; ++i) buf.insertText({10, 3}, "\n");
+        bench::report(std::string(name) + " newline near top", sw.seconds() * 1e6 / newlines, "us/op");
+    }
+
+    std::string paste;
+    for (int i = 0; i < 100; ++i) paste += lines[i] + "\n";
+    const int pastes = 200;
+    {
+        bench::Stopwatch sw;
+        for (int i = 0; i < pastes; ++i) buf.insertText({20, 0}, paste);
+        bench::report(std::string(name) + " paste 100 lines near top", sw.seconds() * 1e6 / pastes, "us/op");
+    }
+
+    const int erases = 2000;
+    {
+        bench::Stopwatch sw;
+        for (int i = 0; i < erases; ++i) buf.eraseRange({30, 0}, {31, 0});
+        bench::report(std::string(name) + " delete line near top", sw.seconds() * 1e6 / erases, "us/op");
+    }
+
+    const int snapshots = 200;
+    {
+        bench::Stopwatch sw;
+        for (int i = 0; i < snapshots; ++i) {
+            auto snap = buf.snapshot();
+            if (snap->lineCount() == 0) std::printf("(empty)\n");
+        }
+        bench::report(std::string(name) + " take snapshot", sw.seconds() * 1e6 / snapshots, "us/op");
+    }
+
+    {
+        auto snap = buf.snapshot();
+        size_t bytes = 0;
+        bench::Stopwatch sw;
+        snap->forEachLine([&bytes](Row, std::string_view text) { bytes += text.size(); });
+        bench::report(std::string(name) + " iterate snapshot", sw.seconds() * 1e3, "ms");
+    }
+
+    const int reads = 200000;
+    {
+        std::mt19937 rng(42);
+        size_t bytes = 0;
+        bench::Stopwatch sw;
+        for (int i = 0; i < reads; ++i) bytes += buf.line(static_cast<int>(rng() % buf.lineCount())).size();
+        bench::report(std::string(name) + " random line read", sw.seconds() * 1e9 / reads, "ns/op");
+        if (bytes == 0) std::printf("(empty)\n");
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int count = argc > 1 ? std::atoi(argv[1]) : 500000;
+    std::vector<std::string> lines = makeLines(count);
+    std::printf("%d lines\n", count);
+    run("piece table:", StorageKind::PieceTable, lines);
+    run("line vector:", StorageKind::LineVector, lines);
+    return 0;
+}
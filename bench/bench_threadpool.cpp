@@ -0,0 +1,132 @@
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include "bench.h"
+#include "concurrent/ThreadPool.h"
+
+// Task throughput of the work-stealing ThreadPool vs. the single-queue pool
+// it replaced (reproduced below): tiny tasks posted from outside the pool,
+// and a fan-out where tasks post their own subtasks - the shape chunked
+// scans take. Also how long a suggestion-sized task waits when it arrives
+// behind a queue of bulk work, on the interactive lane vs. in line with it.
+//
+// Usage: bench_threadpool [tasks] [threads]   (default 200000, hardware threads)
+
+using namespace editor;
+
+namespace {
+
+// The previous implementation, kept here as the baseline: one mutex, one
+// condition variable, std::function around a shared packaged_task.
+class QueuePool {
+public:
+    explicit QueuePool(size_t threads) {
+        for (size_t i = 0; i < threads; ++i) {
+            workers_.emplace_back([this] {
+                for (;;) {
+                    std::function<void()> task;
+                    {
+                        std::unique_lock<std::mutex> lock(mutex_);
+                        cv_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+                        if (stop_ && tasks_.empty()) return;
+                        task = std::move(tasks_.front());
+                        tasks_.pop();
+                    }
+                    task();
+                }
+            });
+        }
+    }
+    ~QueuePool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        for (auto& w : workers_) w.join();
+    }
+    template <typename F>
+    void post(F&& f) {
+        using R = decltype(f());
+        auto task = std::make_shared<std::packaged_task<R()>>(std::forward<F>(f));
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            tasks_.emplace([task]() { (*task)(); });
+        }
+        cv_.notify_one();
+    }
+
+private:
+    std::vector<std::thread> workers_;
+    std::queue<std::function<void()>> tasks_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stop_ = false;
+};
+
+void waitFor(const std::atomic<long long>& counter, long long target) {
+    while (counter.load() < target) std::this_thread::yield();
+}
+
+template <typename Pool>
+double external(size_t threads, int tasks) {
+    Pool pool(threads);
+    std::atomic<long long> done{0};
+    bench::Stopwatch sw;
+    for (int i = 0; i < tasks; ++i) pool.post([&done] { done++; });
+    waitFor(done, tasks);
+    return tasks / sw.seconds() / 1e6;
+}
+
+template <typename Pool>
+double fanOut(size_t threads, int tasks) {
+    Pool pool(threads);
+    std::atomic<long long> done{0};
+    const int roots = 64;
+    const int children = tasks / roots;
+    bench::Stopwatch sw;
+    for (int r = 0; r < roots; ++r) {
+        pool.post([&pool, &done, children] {
+            for (int c = 0; c < children; ++c) pool.post([&done] { done++; });
+        });
+    }
+    waitFor(done, static_cast<long long>(roots) * children);
+    return static_cast<double>(roots) * children / sw.seconds() / 1e6;
+}
+
+void spin(std::chrono::microseconds d) {
+    auto until = std::chrono::steady_clock::now() + d;
+    while (std::chrono::steady_clock::now() < until) {
+    }
+}
+
+double interactiveLatencyMs(size_t threads, Lane lane) {
+    ThreadPool pool(threads);
+    for (int i = 0; i < 100; ++i) pool.post(Lane::Background, [] { spin(std::chrono::microseconds(2000)); });
+    bench::Stopwatch sw;
+    double startedAfter = pool.submit(lane, [&sw] { return sw.seconds() * 1e3; }).get();
+    return startedAfter;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int tasks = argc > 1 ? std::atoi(argv[1]) : 200000;
+    size_t threads = argc > 2 ? std::atoi(argv[2]) : std::max(2u, std::thread::hardware_concurrency());
+    std::printf("%d tasks, %zu threads\n", tasks, threads);
+    bench::report("work-stealing: post from outside", external<ThreadPool>(threads, tasks), "M tasks/s");
+    bench::report("single queue:  post from outside", external<QueuePool>(threads, tasks), "M tasks/s");
+    bench::report("work-stealing: fan-out from tasks", fanOut<ThreadPool>(threads, tasks), "M tasks/s");
+    bench::report("single queue:  fan-out from tasks", fanOut<QueuePool>(threads, tasks), "M tasks/s");
+    bench::report("behind 100 x 2ms bulk tasks: interactive lane", interactiveLatencyMs(threads, Lane::Interactive), "ms");
+    bench::report("behind 100 x 2ms bulk tasks: background lane", interactiveLatencyMs(threads, Lane::Background), "ms");
+    return 0;
+}
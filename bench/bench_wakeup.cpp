@@ -0,0 +1,55 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <poll.h>
+#include <thread>
+#include <vector>
+
+#include "bench.h"
+#include "concurrent/EventQueue.h"
+
+// How long a worker's push() takes to reach a main loop blocked in poll()
+// on the queue's wakeup fd. The old loop polled getch() every 16ms, so a
+// result waited 8ms on average (16ms worst case) before being seen.
+//
+// Usage: bench_wakeup [rounds]   (default 2000)
+
+using namespace editor;
+
+int main(int argc, char** argv) {
+    int rounds = argc > 1 ? std::atoi(argv[1]) : 2000;
+    EventQueue queue;
+    std::atomic<long long> sentAt{0};
+    std::atomic<int> go{0};
+
+    std::thread worker([&] {
+        for (int i = 0; i < rounds; ++i) {
+            while (go.load() <= i) std::this_thread::yield();
+            // Give the main thread time to actually block.
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+            sentAt = std::chrono::steady_clock::now().time_since_epoch().count();
+            queue.push(DictionaryLoadedEvent{static_cast<size_t>(i)});
+        }
+    });
+
+    std::vector<double> latencies;
+    latencies.reserve(rounds);
+    for (int i = 0; i < rounds; ++i) {
+        go = i + 1;
+        pollfd p{queue.wakeFd(), POLLIN, 0};
+        while (poll(&p, 1, -1) != 1) {
+        }
+        long long now = std::chrono::steady_clock::now().time_since_epoch().count();
+        latencies.push_back(std::chrono::duration<double, std::micro>(
+                                std::chrono::steady_clock::duration(now - sentAt.load()))
+                                .count());
+        queue.drainAll();
+    }
+    worker.join();
+
+    std::sort(latencies.begin(), latencies.end());
+    bench::report("push -> poll wakeup, median", latencies[latencies.size() / 2], "us");
+    bench::report("push -> poll wakeup, p99", latencies[latencies.size() * 99 / 100], "us");
+    return 0;
+}
@@ -1,54 +1,149 @@
 #pragma once
-#include <mutex>
-#include <queue>
+#include <atomic>
+#include <cstddef>
+#include <memory>
 #include <string>
 #include <variant>
 #include <vector>
 
+#include "concurrent/WakeupFd.h"
+#include "core/Position.h"
+#include "core/TextBlock.h"
+#include "io/MappedFile.h"
+#include "spell/Completer.h"
 #include "spell/SpellChecker.h"
 #include "spell/Suggester.h"
 
 namespace editor {
 
-struct DictionaryLoadedEvent { size_t wordCount; };
-struct SpellScanEvent { int version; std::vector<MisspelledSpan> spans; };
-struct SuggestEvent { int version; SuggestionResult result; };
-struct SaveCompleteEvent { bool success; std::string path; std::string error; };
+struct DictionaryLoadedEvent { size_t wordCount; double loadMs = 0; };
+// A delta: fresh spans for exactly `rows`, from scan `id`.
+struct SpellScanEvent { int id; std::vector<LineRange> rows; std::vector<MisspelledSpan> spans; };
+// A cacheable result was computed from the deletion index for the
+// lowercased word: it goes in the suggestion cache as is and is shown
+// restyled for `typed`.
+struct SuggestEvent { int version; SuggestionResult result; bool cacheable = false; std::string typed{}; };
+// The deletion index is built; suggestions can be cached from now on.
+struct SuggestionIndexReadyEvent {};
+// Suggestions worked out ahead of time for misspellings near the viewport.
+struct SpeculativeSuggestionsEvent { std::vector<SuggestionResult> results; };
+// Completions for the word ending at `at`, for request `version`.
+struct CompletionEvent { int version; Position at; std::vector<std::string> candidates; };
+// The document's words, as of the snapshot the latest scan was started on.
+struct BufferWordsEvent { std::shared_ptr<const BufferWords> words; };
+struct SaveCompleteEvent {
+    bool success;
+    std::string path;
+    std::string error;
+    size_t bytes = 0;
+    double megabytesPerSecond = 0;
+};
+// The file is open. When it is streamed in, `text` is only its start and
+// LoadChunkEvents with the same `load` follow until `total` bytes are in.
 struct LoadCompleteEvent {
     bool success;
-    std::vector<std::string> lines;
+    TextBlock text; // shares the loader's mapping of the file; nothing is copied
     std::string path;
     std::string error;
     bool trailingNewline = true;
+    int load = 0;
+    size_t total = 0;
+    std::shared_ptr<const MappedFile> mapping{}; // see LoadResult::mapping
 };
+struct LoadChunkEvent { int load; TextBlock text; size_t loaded; size_t total; };
 
-using Event = std::variant<DictionaryLoadedEvent, SpellScanEvent, SuggestEvent, SaveCompleteEvent, LoadCompleteEvent>;
+using Event = std::variant<DictionaryLoadedEvent, SpellScanEvent, SuggestEvent, SuggestionIndexReadyEvent,
+                           SpeculativeSuggestionsEvent, CompletionEvent, BufferWordsEvent, SaveCompleteEvent,
+                           LoadCompleteEvent, LoadChunkEvent>;
 
 // Worker -> main-thread mailbox. Workers only ever call push(); the main
 // thread drains it once per loop iteration. This is the only channel
 // through which background results reach the UI - workers never call
 // ncurses or touch the live Document directly.
+//
+// Lock-free multi-producer/single-consumer (Dmitry Vyukov's intrusive
+// node queue): push() is one atomic exchange plus one store, and drain()
+// visits events in place, so an idle loop iteration is a single atomic
+// load with no allocation. Only one thread may drain.
+//
+// wakeFd() polls readable while events are waiting, so the main loop can
+// sleep until there is something to do instead of polling on a timer.
 class EventQueue {
 public:
+    EventQueue() : head_(&stub_), tail_(&stub_) {}
+    ~EventQueue() {
+        Node* n = tail_ == &stub_ ? stub_.next.load() : tail_;
+        while (n) {
+            Node* next = n->next.load();
+            delete n;
+            n = next;
+        }
+    }
+
+    EventQueue(const EventQueue&) = delete;
+    EventQueue& operator=(const EventQueue&) = delete;
+
     void push(Event e) {
-        std::lock_guard<std::mutex> lock(mutex_);
-        queue_.push(std::move(e));
+        Node* node = new Node{{nullptr}, std::move(e)};
+        Node* prev = head_.exchange(node, std::memory_order_acq_rel);
+        // Between these two lines the chain is briefly broken at `prev`;
+        // drain() just stops there and this push's wakeup brings it back.
+        prev->next.store(node, std::memory_order_release);
+        // Only the first push since the last drain needs to wake the
+        // consumer; the acq_rel pairs with drain()'s exchange so the node
+        // linked above is visible to it.
+        if (!wakePending_.exchange(true, std::memory_order_acq_rel)) wakeup_.signal();
     }
 
+    // Calls visit(Event&) for every queued event, oldest first, and returns
+    // how many there were. Consumer thread only. Events pushed while
+    // draining may or may not be visited; if not, wakeFd() stays readable.
+    template <typename F>
+    size_t drain(F&& visit) {
+        // Clear the fd before re-arming the flag: a push that races past
+        // either step then signals (or has signalled) after the clear. No
+        // flag, no signal to clear - skip the syscall on idle iterations.
+        if (wakePending_.load(std::memory_order_acquire)) {
+            wakeup_.clear();
+            wakePending_.exchange(false, std::memory_order_acq_rel);
+        }
+
+        size_t count = 0;
+        for (;;) {
+            Node* tail = tail_;
+            Node* next = tail->next.load(std::memory_order_acquire);
+            if (!next) break;
+            // `next` becomes the new stub; its event is consumed in place
+            // and then released so large payloads don't linger.
+            tail_ = next;
+            if (tail != &stub_) delete tail;
+            visit(next->value);
+            next->value = Event{};
+            ++count;
+        }
+        return count;
+    }
+
+    // Allocating convenience for tests and callers that want a batch.
     std::vector<Event> drainAll() {
-        std::lock_guard<std::mutex> lock(mutex_);
         std::vector<Event> out;
-        out.reserve(queue_.size());
-        while (!queue_.empty()) {
-            out.push_back(std::move(queue_.front()));
-            queue_.pop();
-        }
+        drain([&out](Event& e) { out.push_back(std::move(e)); });
         return out;
     }
 
+    int wakeFd() const { return wakeup_.fd(); }
+
 private:
-    std::queue<Event> queue_;
-    std::mutex mutex_;
+    struct Node {
+        std::atomic<Node*> next;
+        Event value;
+    };
+
+    Node stub_{{nullptr}, Event{}};
+    std::atomic<Node*> head_; // producers: most recently pushed node
+    Node* tail_;              // consumer: last consumed node (or the stub)
+    std::atomic<bool> wakePending_{false};
+    WakeupFd wakeup_;
 };
 
 } // namespace editor
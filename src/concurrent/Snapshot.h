@@ -3,15 +3,25 @@
 #include <string>
 #include <vector>
 
+#include "core/TextBuffer.h"
+#include "core/TextSnapshot.h"
+
 namespace editor {
 
-// An immutable, shareable copy of the buffer's lines, handed to worker
+// An immutable, shareable view of the buffer's lines, handed to worker
 // threads so they never touch the live TextBuffer. Paired with a version
 // number by the caller so late-arriving results can be detected as stale.
-using BufferSnapshot = std::shared_ptr<const std::vector<std::string>>;
+//
+// With the piece-table backend this shares structure with the live buffer,
+// so taking one is O(1) rather than a copy of every line.
+using BufferSnapshot = std::shared_ptr<const TextSnapshot>;
+
+inline BufferSnapshot makeSnapshot(const TextBuffer& buffer) {
+    return buffer.snapshot();
+}
 
-inline BufferSnapshot makeSnapshot(const std::vector<std::string>& lines) {
-    return std::make_shared<const std::vector<std::string>>(lines);
+inline BufferSnapshot makeSnapshot(std::vector<std::string> lines) {
+    return std::make_shared<const LineVectorSnapshot>(std::move(lines));
 }
 
 } // namespace editor
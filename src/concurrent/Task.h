@@ -0,0 +1,96 @@
+#pragma once
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace editor {
+
+// Move-only `void()` callable with inline storage. Callables up to
+// kInlineBytes (the lambdas Editor.cpp posts: a few pointers, strings,
+// positions and shared_ptrs - the largest, a completion request, is
+// static_asserted to fit) live inside the Task itself, so a queued task
+// costs one allocation instead of std::function's separate heap block;
+// larger ones fall back to the heap. Unlike std::function it accepts move-only
+// callables, e.g. a lambda owning a std::promise.
+class Task {
+public:
+    static constexpr size_t kInlineBytes = 96;
+
+    Task() = default;
+
+    template <typename F, typename Fn = std::decay_t<F>,
+              typename = std::enable_if_t<!std::is_same_v<Fn, Task>>>
+    Task(F&& f) { // NOLINT: implicit, like std::function
+        if constexpr (fitsInline<Fn>()) {
+            ::new (static_cast<void*>(storage_)) Fn(std::forward<F>(f));
+            ops_ = &inlineOps<Fn>;
+        } else {
+            ::new (static_cast<void*>(storage_)) Fn*(new Fn(std::forward<F>(f)));
+            ops_ = &heapOps<Fn>;
+        }
+    }
+
+    Task(Task&& other) noexcept : ops_(other.ops_) {
+        if (ops_) ops_->move(other.storage_, storage_);
+        other.ops_ = nullptr;
+    }
+
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            reset();
+            ops_ = other.ops_;
+            if (ops_) ops_->move(other.storage_, storage_);
+            other.ops_ = nullptr;
+        }
+        return *this;
+    }
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    ~Task() { reset(); }
+
+    void operator()() { ops_->invoke(storage_); }
+    explicit operator bool() const { return ops_ != nullptr; }
+
+private:
+    struct Ops {
+        void (*invoke)(void*);
+        void (*move)(void* from, void* to); // move-constructs into `to`, destroys `from`
+        void (*destroy)(void*);
+    };
+
+    template <typename Fn>
+    static constexpr bool fitsInline() {
+        return sizeof(Fn) <= kInlineBytes && alignof(Fn) <= alignof(std::max_align_t) &&
+               std::is_nothrow_move_constructible_v<Fn>;
+    }
+
+    template <typename Fn>
+    static constexpr Ops inlineOps = {
+        [](void* p) { (*static_cast<Fn*>(p))(); },
+        [](void* from, void* to) {
+            ::new (to) Fn(std::move(*static_cast<Fn*>(from)));
+            static_cast<Fn*>(from)->~Fn();
+        },
+        [](void* p) { static_cast<Fn*>(p)->~Fn(); },
+    };
+
+    template <typename Fn>
+    static constexpr Ops heapOps = {
+        [](void* p) { (**static_cast<Fn**>(p))(); },
+        [](void* from, void* to) { ::new (to) Fn*(*static_cast<Fn**>(from)); },
+        [](void* p) { delete *static_cast<Fn**>(p); },
+    };
+
+    void reset() {
+        if (ops_) ops_->destroy(storage_);
+        ops_ = nullptr;
+    }
+
+    alignas(std::max_align_t) unsigned char storage_[kInlineBytes];
+    const Ops* ops_ = nullptr;
+};
+
+} // namespace editor
@@ -2,32 +2,173 @@
 
 namespace editor {
 
-ThreadPool::ThreadPool(size_t threads) {
+namespace {
+// Which pool and worker the current thread is, so post() from inside a task
+// can use the worker's own deque.
+thread_local ThreadPool* tlsPool = nullptr;
+thread_local size_t tlsWorker = 0;
+
+size_t laneIndex(Lane lane) { return static_cast<size_t>(lane); }
+} // namespace
+
+ThreadPool::ThreadPool(size_t threads, size_t bulkWorkers) {
+    threads = std::max<size_t>(threads, 1);
+    bulkLimit_ = bulkWorkers ? std::min(bulkWorkers, threads) : std::max<size_t>(threads - 1, 1);
+    for (size_t i = 0; i < threads; ++i) workers_.push_back(std::make_unique<Worker>());
+    // Start threads only once every deque exists - thieves index into workers_.
     for (size_t i = 0; i < threads; ++i) {
-        workers_.emplace_back([this] {
-            for (;;) {
-                std::function<void()> task;
-                {
-                    std::unique_lock<std::mutex> lock(mutex_);
-                    cv_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
-                    if (stop_ && tasks_.empty()) return;
-                    task = std::move(tasks_.front());
-                    tasks_.pop();
-                }
-                task();
-            }
-        });
+        workers_[i]->thread = std::thread([this, i] { workerLoop(i); });
     }
 }
 
 ThreadPool::~ThreadPool() {
     {
-        std::lock_guard<std::mutex> lock(mutex_);
+        std::lock_guard<std::mutex> lock(sleepMutex_);
         stop_ = true;
+        wakeEpoch_++;
     }
-    cv_.notify_all();
+    sleepCv_.notify_all();
     for (auto& w : workers_) {
-        if (w.joinable()) w.join();
+        if (w->thread.joinable()) w->thread.join();
+    }
+}
+
+LaneStats ThreadPool::laneStats(Lane lane) const {
+    const LaneCounters& c = counters_[laneIndex(lane)];
+    LaneStats s;
+    s.queued = c.queued.load();
+    s.started = c.started.load();
+    s.completed = c.completed.load();
+    s.totalWaitMs = c.totalWaitNs.load() / 1e6;
+    s.maxWaitMs = c.maxWaitNs.load() / 1e6;
+    return s;
+}
+
+void ThreadPool::schedule(QueuedTask* task) {
+    // Once published, a worker may run and delete the task at any moment.
+    Lane lane = task->lane;
+    counters_[laneIndex(lane)].queued.fetch_add(1, std::memory_order_relaxed);
+    if (tlsPool == this && lane != Lane::Interactive) {
+        workers_[tlsWorker]->deque.push(task);
+    } else {
+        Injector& inj = injectors_[laneIndex(lane)];
+        std::lock_guard<std::mutex> lock(inj.mutex);
+        inj.tasks.push_back(task);
+        inj.size.fetch_add(1, std::memory_order_seq_cst);
+    }
+    // Pairs with the sleepers_ increment in workerLoop(): either the worker
+    // re-checking the queues sees this task, or this sees the sleeper. Bulk
+    // work with every bulk slot taken wakes nobody: a sleeper couldn't run
+    // it, and the slot holders look for more before they sleep.
+    if (lane != Lane::Interactive && bulkRunning_.load(std::memory_order_seq_cst) >= bulkLimit_) return;
+    if (sleepers_.load(std::memory_order_seq_cst) > 0) {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex_);
+            wakeEpoch_++;
+        }
+        sleepCv_.notify_one();
+    }
+}
+
+ThreadPool::QueuedTask* ThreadPool::popInjector(Lane lane) {
+    Injector& inj = injectors_[laneIndex(lane)];
+    if (inj.size.load(std::memory_order_seq_cst) == 0) return nullptr;
+    std::lock_guard<std::mutex> lock(inj.mutex);
+    if (inj.tasks.empty()) return nullptr;
+    QueuedTask* t = inj.tasks.front();
+    inj.tasks.pop_front();
+    inj.size.fetch_sub(1, std::memory_order_seq_cst);
+    return t;
+}
+
+bool ThreadPool::tryAcquireBulkSlot() {
+    size_t running = bulkRunning_.load(std::memory_order_seq_cst);
+    while (running < bulkLimit_) {
+        if (bulkRunning_.compare_exchange_weak(running, running + 1, std::memory_order_seq_cst)) return true;
+    }
+    return false;
+}
+
+// Caller holds a bulk slot.
+ThreadPool::QueuedTask* ThreadPool::findBulkWork(size_t index) {
+    if (QueuedTask* t = workers_[index]->deque.pop()) return t;
+    // Explicit I/O the user asked for (saves, loads) before background scans.
+    if (QueuedTask* t = popInjector(Lane::IO)) return t;
+    if (QueuedTask* t = popInjector(Lane::Background)) return t;
+    // Steal, starting from the next worker so thieves spread out.
+    for (size_t k = 1; k < workers_.size(); ++k) {
+        if (QueuedTask* t = workers_[(index + k) % workers_.size()]->deque.steal()) return t;
+    }
+    return nullptr;
+}
+
+// Returns a task to run; for a bulk task the caller then holds a bulk slot.
+ThreadPool::QueuedTask* ThreadPool::findWork(size_t index) {
+    if (QueuedTask* t = popInjector(Lane::Interactive)) return t;
+    if (!tryAcquireBulkSlot()) return nullptr;
+    if (QueuedTask* t = findBulkWork(index)) return t;
+    bulkRunning_.fetch_sub(1, std::memory_order_seq_cst);
+    return nullptr;
+}
+
+bool ThreadPool::hasWork() const {
+    if (injectors_[laneIndex(Lane::Interactive)].size.load(std::memory_order_seq_cst) > 0) return true;
+    // Bulk work this worker can't take yet is left to the slot holders,
+    // which pick it up as soon as their current task finishes.
+    if (bulkRunning_.load(std::memory_order_seq_cst) >= bulkLimit_) return false;
+    if (injectors_[laneIndex(Lane::IO)].size.load(std::memory_order_seq_cst) > 0) return true;
+    if (injectors_[laneIndex(Lane::Background)].size.load(std::memory_order_seq_cst) > 0) return true;
+    for (const auto& w : workers_) {
+        if (!w->deque.empty()) return true;
+    }
+    return false;
+}
+
+void ThreadPool::run(QueuedTask* task) {
+    LaneCounters& c = counters_[laneIndex(task->lane)];
+    auto waited = std::chrono::steady_clock::now() - task->posted;
+    uint64_t waitNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(waited).count());
+    c.queued.fetch_sub(1, std::memory_order_relaxed);
+    c.started.fetch_add(1, std::memory_order_relaxed);
+    c.totalWaitNs.fetch_add(waitNs, std::memory_order_relaxed);
+    uint64_t prevMax = c.maxWaitNs.load(std::memory_order_relaxed);
+    while (waitNs > prevMax && !c.maxWaitNs.compare_exchange_weak(prevMax, waitNs, std::memory_order_relaxed)) {
+    }
+
+    try {
+        task->fn();
+    } catch (...) {
+        // Nobody is listening (see post()); keep the worker alive.
+    }
+    c.completed.fetch_add(1, std::memory_order_relaxed);
+    if (task->lane != Lane::Interactive) bulkRunning_.fetch_sub(1, std::memory_order_seq_cst);
+    delete task;
+}
+
+void ThreadPool::workerLoop(size_t index) {
+    tlsPool = this;
+    tlsWorker = index;
+    for (;;) {
+        if (QueuedTask* task = findWork(index)) {
+            run(task);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        sleepers_.fetch_add(1, std::memory_order_seq_cst);
+        if (hasWork()) {
+            sleepers_.fetch_sub(1, std::memory_order_seq_cst);
+            continue;
+        }
+        // A bulk slot holder always finishes what is queued before it
+        // sleeps, so exiting here never strands work.
+        if (stop_) {
+            sleepers_.fetch_sub(1, std::memory_order_seq_cst);
+            return;
+        }
+        uint64_t epoch = wakeEpoch_;
+        sleepCv_.wait(lock, [this, epoch] { return stop_ || wakeEpoch_ != epoch; });
+        sleepers_.fetch_sub(1, std::memory_order_seq_cst);
     }
 }
 
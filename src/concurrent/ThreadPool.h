@@ -1,48 +1,157 @@
 #pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
-#include <functional>
+#include <cstdint>
+#include <deque>
+#include <exception>
 #include <future>
 #include <memory>
 #include <mutex>
-#include <queue>
 #include <thread>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+#include "concurrent/Task.h"
+#include "concurrent/WorkStealingDeque.h"
+
 namespace editor {
 
-// Fixed-size worker pool. submit() returns a future; the underlying task
-// stays alive via the queued std::function even if the caller discards the
-// future (fire-and-forget submissions are the common case here).
+// Scheduling class of a task. Interactive work (a suggestion the user is
+// waiting on) is always picked before anything else; Background (spell
+// scans) and IO (dictionary and file loads, saves) are bulk work, and only
+// a capped number of workers may run bulk work at once so an interactive
+// task never waits for a whole scan or save to finish. A bulk task must
+// therefore never block waiting on another bulk task - with the cap at one
+// worker that would deadlock.
+enum class Lane { Interactive, Background, IO };
+constexpr size_t kLaneCount = 3;
+
+struct LaneStats {
+    int64_t queued = 0;       // posted but not yet started
+    uint64_t started = 0;
+    uint64_t completed = 0;
+    double totalWaitMs = 0;   // summed post-to-start time of started tasks
+    double maxWaitMs = 0;
+};
+
+// Fixed-size work-stealing pool. Each worker owns a Chase-Lev deque: bulk
+// tasks posted from inside a task go onto the posting worker's own deque
+// (no lock, LIFO for cache warmth) and idle workers steal the oldest ones
+// from each other. Tasks posted from outside the pool (the UI thread), and
+// all interactive tasks, go through small per-lane injector queues that
+// every worker checks, interactive first.
+//
+// post() is fire-and-forget - the common case here - and costs a single
+// allocation (the queued task, with the callable stored inline). submit()
+// wraps the callable with a promise for callers that want a future.
 //
-// On destruction, workers finish draining the queue before joining (a
-// graceful shutdown, not an abrupt cancel) - see the worker loop below.
+// On destruction, workers finish all queued work, including tasks that
+// queued work posts, before joining (a graceful shutdown, not an abrupt
+// cancel).
 class ThreadPool {
 public:
-    explicit ThreadPool(size_t threads = std::max(2u, std::thread::hardware_concurrency()));
+    // `bulkWorkers` caps how many workers run Background/IO tasks at once;
+    // 0 means all but one, so one worker is always free for interactive work.
+    explicit ThreadPool(size_t threads = std::max(2u, std::thread::hardware_concurrency()), size_t bulkWorkers = 0);
     ~ThreadPool();
 
     ThreadPool(const ThreadPool&) = delete;
     ThreadPool& operator=(const ThreadPool&) = delete;
 
+    // Runs `f` on some worker. An exception escaping `f` is swallowed, as it
+    // was when callers discarded submit()'s future.
+    template <typename F>
+    void post(Lane lane, F&& f) {
+        schedule(new QueuedTask{Task(std::forward<F>(f)), lane, std::chrono::steady_clock::now()});
+    }
+
+    template <typename F>
+    void post(F&& f) {
+        post(Lane::Background, std::forward<F>(f));
+    }
+
     template <typename F>
-    auto submit(F&& f) -> std::future<decltype(f())> {
-        using R = decltype(f());
-        auto task = std::make_shared<std::packaged_task<R()>>(std::forward<F>(f));
-        std::future<R> fut = task->get_future();
-        {
-            std::lock_guard<std::mutex> lock(mutex_);
-            tasks_.emplace([task]() { (*task)(); });
-        }
-        cv_.notify_one();
+    auto submit(Lane lane, F&& f) -> std::future<std::invoke_result_t<std::decay_t<F>&>> {
+        using R = std::invoke_result_t<std::decay_t<F>&>;
+        std::promise<R> promise;
+        std::future<R> fut = promise.get_future();
+        post(lane, [promise = std::move(promise), fn = std::forward<F>(f)]() mutable {
+            try {
+                if constexpr (std::is_void_v<R>) {
+                    fn();
+                    promise.set_value();
+                } else {
+                    promise.set_value(fn());
+                }
+            } catch (...) {
+                promise.set_exception(std::current_exception());
+            }
+        });
         return fut;
     }
 
+    template <typename F>
+    auto submit(F&& f) {
+        return submit(Lane::Background, std::forward<F>(f));
+    }
+
+    size_t size() const { return workers_.size(); }
+    size_t bulkWorkerLimit() const { return bulkLimit_; }
+    LaneStats laneStats(Lane lane) const;
+
 private:
-    std::vector<std::thread> workers_;
-    std::queue<std::function<void()>> tasks_;
-    std::mutex mutex_;
-    std::condition_variable cv_;
+    struct QueuedTask {
+        Task fn;
+        Lane lane;
+        std::chrono::steady_clock::time_point posted;
+    };
+
+    struct Worker {
+        WorkStealingDeque<QueuedTask> deque; // bulk lanes only
+        std::thread thread;
+    };
+
+    struct Injector {
+        std::mutex mutex;
+        std::deque<QueuedTask*> tasks;
+        std::atomic<size_t> size{0};
+    };
+
+    struct LaneCounters {
+        std::atomic<int64_t> queued{0};
+        std::atomic<uint64_t> started{0};
+        std::atomic<uint64_t> completed{0};
+        std::atomic<uint64_t> totalWaitNs{0};
+        std::atomic<uint64_t> maxWaitNs{0};
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::array<Injector, kLaneCount> injectors_;
+    std::array<LaneCounters, kLaneCount> counters_;
+    size_t bulkLimit_;
+    std::atomic<size_t> bulkRunning_{0};
+
+    // Sleeping: a worker that finds no work announces itself in sleepers_,
+    // re-checks every queue, then waits for wakeEpoch_ to move. schedule()
+    // only takes sleepMutex_ when someone is (about to be) asleep.
+    std::mutex sleepMutex_;
+    std::condition_variable sleepCv_;
+    std::atomic<int> sleepers_{0};
+    uint64_t wakeEpoch_ = 0;
     bool stop_ = false;
+
+    void schedule(QueuedTask* task);
+    void run(QueuedTask* task);
+    void workerLoop(size_t index);
+    QueuedTask* findWork(size_t index);
+    QueuedTask* findBulkWork(size_t index);
+    QueuedTask* popInjector(Lane lane);
+    bool tryAcquireBulkSlot();
+    bool hasWork() const;
 };
 
 } // namespace editor
@@ -0,0 +1,47 @@
+#include "concurrent/WakeupFd.h"
+
+#include <cstdint>
+#include <fcntl.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/eventfd.h>
+#endif
+
+namespace editor {
+
+WakeupFd::WakeupFd() {
+#ifdef __linux__
+    readFd_ = writeFd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+#else
+    int fds[2];
+    if (pipe(fds) == 0) {
+        for (int fd : fds) {
+            fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+            fcntl(fd, F_SETFD, FD_CLOEXEC);
+        }
+        readFd_ = fds[0];
+        writeFd_ = fds[1];
+    }
+#endif
+}
+
+WakeupFd::~WakeupFd() {
+    if (readFd_ >= 0) close(readFd_);
+    if (writeFd_ >= 0 && writeFd_ != readFd_) close(writeFd_);
+}
+
+void WakeupFd::signal() {
+    // A full pipe or a saturated counter already means "readable", so a
+    // failed write loses nothing.
+    uint64_t one = 1;
+    ssize_t n = write(writeFd_, &one, writeFd_ == readFd_ ? sizeof one : 1);
+    (void)n;
+}
+
+void WakeupFd::clear() {
+    char buf[64];
+    while (read(readFd_, buf, sizeof buf) > 0) {
+    }
+}
+
+} // namespace editor
@@ -0,0 +1,30 @@
+#pragma once
+
+namespace editor {
+
+// A file descriptor that becomes readable when another thread calls
+// signal(), so the main loop can block in poll() on the terminal and on
+// worker results at the same time. An eventfd on Linux, a non-blocking
+// self-pipe elsewhere. Signals coalesce: any number of signal() calls
+// before the next clear() produce one wakeup.
+class WakeupFd {
+public:
+    WakeupFd();
+    ~WakeupFd();
+
+    WakeupFd(const WakeupFd&) = delete;
+    WakeupFd& operator=(const WakeupFd&) = delete;
+
+    // Safe from any thread (and from a signal handler).
+    void signal();
+    // Consumes pending signals so the fd stops polling readable.
+    void clear();
+
+    int fd() const { return readFd_; }
+
+private:
+    int readFd_ = -1;
+    int writeFd_ = -1;
+};
+
+} // namespace editor
@@ -0,0 +1,107 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace editor {
+
+// Chase-Lev work-stealing deque of pointers (Le, Pop, Cohen, Zappa Nardelli,
+// "Correct and Efficient Work-Stealing for Weak Memory Models", PPoPP'13).
+// The owning thread pushes and pops at the bottom without locking; any
+// other thread may steal from the top, contending only on one CAS when the
+// deque is down to its last element.
+//
+// The paper's standalone fences are folded into seq_cst/release/acquire
+// operations on top_ and bottom_, which ThreadSanitizer understands; every
+// store to bottom_ is at least a release so a thief that reads it also sees
+// the items the owner published before it. Capacity is a power of two. Arrays
+// outgrown by push() are retired, not freed, since a thief may still be
+// reading one; they are released with the deque.
+template <typename T>
+class WorkStealingDeque {
+public:
+    explicit WorkStealingDeque(int64_t capacity = 256) {
+        auto array = std::make_unique<Array>(capacity);
+        array_.store(array.get(), std::memory_order_relaxed);
+        arrays_.push_back(std::move(array));
+    }
+
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+    // Owner only.
+    void push(T* item) {
+        int64_t b = bottom_.load(std::memory_order_relaxed);
+        int64_t t = top_.load(std::memory_order_acquire);
+        Array* a = array_.load(std::memory_order_relaxed);
+        if (b - t > a->capacity - 1) a = grow(a, t, b);
+        a->put(b, item);
+        bottom_.store(b + 1, std::memory_order_release);
+    }
+
+    // Owner only. Newest first; nullptr when empty.
+    T* pop() {
+        int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+        Array* a = array_.load(std::memory_order_relaxed);
+        bottom_.store(b, std::memory_order_seq_cst);
+        int64_t t = top_.load(std::memory_order_seq_cst);
+        if (t > b) {
+            bottom_.store(b + 1, std::memory_order_release);
+            return nullptr;
+        }
+        T* item = a->get(b);
+        if (t == b) {
+            // Last element: race thieves for it.
+            if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                item = nullptr;
+            }
+            bottom_.store(b + 1, std::memory_order_release);
+        }
+        return item;
+    }
+
+    // Any thread. Oldest first; nullptr when empty or when it lost a race.
+    T* steal() {
+        int64_t t = top_.load(std::memory_order_seq_cst);
+        int64_t b = bottom_.load(std::memory_order_seq_cst);
+        if (t >= b) return nullptr;
+        Array* a = array_.load(std::memory_order_acquire);
+        T* item = a->get(t);
+        if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return item;
+    }
+
+    // Approximate when called concurrently; exact from the owner when idle.
+    bool empty() const {
+        return bottom_.load(std::memory_order_seq_cst) <= top_.load(std::memory_order_seq_cst);
+    }
+
+private:
+    struct Array {
+        explicit Array(int64_t cap) : capacity(cap), slots(new std::atomic<T*>[cap]) {}
+        int64_t capacity;
+        std::unique_ptr<std::atomic<T*>[]> slots;
+
+        T* get(int64_t i) const { return slots[i & (capacity - 1)].load(std::memory_order_relaxed); }
+        void put(int64_t i, T* item) { slots[i & (capacity - 1)].store(item, std::memory_order_relaxed); }
+    };
+
+    Array* grow(Array* old, int64_t t, int64_t b) {
+        auto bigger = std::make_unique<Array>(old->capacity * 2);
+        for (int64_t i = t; i < b; ++i) bigger->put(i, old->get(i));
+        Array* raw = bigger.get();
+        arrays_.push_back(std::move(bigger));
+        array_.store(raw, std::memory_order_release);
+        return raw;
+    }
+
+    std::atomic<int64_t> top_{0};
+    std::atomic<int64_t> bottom_{0};
+    std::atomic<Array*> array_;
+    std::vector<std::unique_ptr<Array>> arrays_; // owner only; index 0 is the first array
+};
+
+} // namespace editor
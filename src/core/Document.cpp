@@ -2,7 +2,10 @@
 
 #include <algorithm>
 #include <cctype>
+#include <optional>
+#include <string_view>
 #include <utility>
+#include <vector>
 
 namespace editor {
 
@@ -25,7 +28,7 @@ void Document::backspace() {
 
     Position from = (cur.col > 0)
         ? Position{cur.row, cur.col - 1}
-        : Position{cur.row - 1, static_cast<int>(buffer_.lines()[cur.row - 1].size())};
+        : Position{cur.row - 1, buffer_.lineLength(cur.row - 1)};
 
     std::string removed = buffer_.eraseRange(from, cur);
     undo_.record(from, removed, "");
@@ -34,7 +37,7 @@ void Document::backspace() {
 void Document::deleteForward() {
     Position cur = buffer_.cursor();
     Position to;
-    if (cur.col < static_cast<int>(buffer_.lines()[cur.row].size())) {
+    if (cur.col < buffer_.lineLength(cur.row)) {
         to = {cur.row, cur.col + 1};
     } else if (cur.row + 1 < buffer_.lineCount()) {
         to = {cur.row + 1, 0};
@@ -106,61 +109,95 @@ std::string toLowerCopy(std::string s) {
     std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return std::tolower(c); });
     return s;
 }
+
+// findNext() reads rows through a snapshot this many at a time: one
+// sequential walk of the storage per block instead of a lookup per row,
+// which matters once a piece holds thousands of lines (a large file).
+constexpr Row kSearchBlockRows = 4096;
 } // namespace
 
 bool Document::findNext(const std::string& needle, bool caseSensitive) {
     if (needle.empty()) return false;
     std::string target = caseSensitive ? needle : toLowerCopy(needle);
     Position cur = buffer_.cursor();
-    int rows = buffer_.lineCount();
+    Row rows = buffer_.lineCount();
+    auto snapshot = buffer_.snapshot();
 
-    auto searchRow = [&](int r, size_t fromCol, size_t toCol) -> long {
-        std::string hay = buffer_.lines()[r];
+    auto searchRow = [&](std::string_view line, size_t fromCol, size_t toCol) -> long {
+        std::string hay(line);
         if (!caseSensitive) hay = toLowerCopy(hay);
         if (toCol < hay.size()) hay = hay.substr(0, toCol);
         if (fromCol > hay.size()) return -1;
         size_t pos = hay.find(target, fromCol);
         return pos == std::string::npos ? -1 : static_cast<long>(pos);
     };
+    // The first match on rows [first, last); `wrapped` says which side of
+    // the cursor its own row is searched on.
+    auto searchRows = [&](Row first, Row last, bool wrapped) -> std::optional<Position> {
+        std::optional<Position> found;
+        for (Row block = first; block < last && !found; block += kSearchBlockRows) {
+            snapshot->forEachLine(block, std::min(last, block + kSearchBlockRows), [&](Row r, std::string_view line) {
+                if (found) return;
+                size_t fromCol = r == cur.row && !wrapped ? static_cast<size_t>(cur.col + 1) : 0;
+                size_t toCol = r == cur.row && wrapped ? static_cast<size_t>(cur.col + 1) : std::string::npos;
+                long pos = searchRow(line, fromCol, toCol);
+                if (pos >= 0) found = Position{r, static_cast<int>(pos)};
+            });
+        }
+        return found;
+    };
 
-    // Phase 1: from just after the cursor to the end of the buffer.
-    for (int r = cur.row; r < rows; ++r) {
-        size_t fromCol = (r == cur.row) ? static_cast<size_t>(cur.col + 1) : 0;
-        long pos = searchRow(r, fromCol, std::string::npos);
-        if (pos >= 0) { selectMatch({r, static_cast<int>(pos)}, static_cast<int>(target.size())); return true; }
-    }
-    // Phase 2: wrap around, from the start of the buffer up to the cursor.
-    for (int r = 0; r <= cur.row; ++r) {
-        size_t toCol = (r == cur.row) ? static_cast<size_t>(cur.col + 1) : std::string::npos;
-        long pos = searchRow(r, 0, toCol);
-        if (pos >= 0) { selectMatch({r, static_cast<int>(pos)}, static_cast<int>(target.size())); return true; }
-    }
-    return false;
+    // Phase 1: from just after the cursor to the end of the buffer. Phase 2:
+    // wrap around, from the start of the buffer up to the cursor.
+    std::optional<Position> match = searchRows(cur.row, rows, false);
+    if (!match) match = searchRows(0, cur.row + 1, true);
+    if (!match) return false;
+    selectMatch(*match, static_cast<int>(target.size()));
+    return true;
 }
 
 int Document::replaceAll(const std::string& needle, const std::string& replacement, bool caseSensitive) {
     if (needle.empty()) return 0;
     std::string target = caseSensitive ? needle : toLowerCopy(needle);
-    int count = 0;
-    Position pos{0, 0};
 
-    while (pos.row < buffer_.lineCount()) {
-        std::string hay = buffer_.lines()[pos.row];
-        if (!caseSensitive) hay = toLowerCopy(hay);
-        size_t idx = hay.find(target, pos.col);
-        if (idx == std::string::npos) {
-            pos = {pos.row + 1, 0};
-            continue;
-        }
-        Position start{pos.row, static_cast<int>(idx)};
-        Position end{pos.row, static_cast<int>(idx + target.size())};
+    // Find every match first, reading the rows through one snapshot in
+    // blocks as findNext() does, then edit.
+    std::vector<Position> matches;
+    auto snapshot = buffer_.snapshot();
+    Row rows = snapshot->lineCount();
+    for (Row block = 0; block < rows; block += kSearchBlockRows) {
+        snapshot->forEachLine(block, std::min(rows, block + kSearchBlockRows), [&](Row r, std::string_view line) {
+            std::string hay(line);
+            if (!caseSensitive) hay = toLowerCopy(hay);
+            for (size_t idx = hay.find(target); idx != std::string::npos; idx = hay.find(target, idx + target.size())) {
+                matches.push_back({r, static_cast<int>(idx)});
+            }
+        });
+    }
+
+    // Each replacement moves what follows it on its row - and, if it holds
+    // newlines, every later row - so matches are shifted to where they now are.
+    Row newlines = std::count(replacement.begin(), replacement.end(), '\n');
+    int lastLineLength = static_cast<int>(newlines ? replacement.size() - replacement.rfind('\n') - 1 : replacement.size());
+    Row rowShift = 0, lastRow = -1;
+    int colShift = 0;
+    for (Position m : matches) {
+        if (m.row != lastRow) colShift = 0;
+        lastRow = m.row;
+        Position start{m.row + rowShift, m.col + colShift};
+        Position end{start.row, start.col + static_cast<int>(target.size())};
         std::string removed = buffer_.eraseRange(start, end);
         buffer_.insertText(start, replacement);
         undo_.record(start, removed, replacement);
-        count++;
-        pos = {start.row, start.col + static_cast<int>(replacement.size())};
+        int matchEnd = m.col + static_cast<int>(target.size());
+        if (newlines) {
+            rowShift += newlines;
+            colShift = lastLineLength - matchEnd;
+        } else {
+            colShift += static_cast<int>(replacement.size()) - static_cast<int>(target.size());
+        }
     }
-    return count;
+    return static_cast<int>(matches.size());
 }
 
 void Document::loadLines(std::vector<std::string> lines) {
@@ -169,4 +206,14 @@ void Document::loadLines(std::vector<std::string> lines) {
     selecting_ = false;
 }
 
+void Document::loadText(TextBlock text) {
+    loadText(std::move(text), buffer_.storageKind());
+}
+
+void Document::loadText(TextBlock text, StorageKind kind) {
+    buffer_.loadText(std::move(text), kind);
+    undo_ = UndoStack{};
+    selecting_ = false;
+}
+
 } // namespace editor
@@ -15,6 +15,7 @@ namespace editor {
 class Document {
 public:
     Document() = default;
+    explicit Document(StorageKind kind) : buffer_(kind) {}
 
     TextBuffer& buffer() { return buffer_; }
     const TextBuffer& buffer() const { return buffer_; }
@@ -50,6 +51,10 @@ public:
     void markClean() { buffer_.clearModified(); }
 
     void loadLines(std::vector<std::string> lines);
+    void loadText(TextBlock text);
+    void loadText(TextBlock text, StorageKind kind);
+    // The rest of a file that is still loading; see TextBuffer::appendText.
+    void appendText(TextBlock text) { buffer_.appendText(std::move(text)); }
 
 private:
     TextBuffer buffer_;
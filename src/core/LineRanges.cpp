@@ -0,0 +1,71 @@
+#include "core/LineRanges.h"
+
+#include <algorithm>
+
+namespace editor {
+
+bool remapRow(Row& row, const LineChange& change) {
+    if (row < change.row) return true;
+    if (row < change.row + change.removed) return false;
+    row += change.inserted - change.removed;
+    return true;
+}
+
+std::vector<LineRange> remapRanges(const std::vector<LineRange>& ranges, const LineChange& change) {
+    Row replacedEnd = change.row + change.removed;
+    Row shift = change.inserted - change.removed;
+    std::vector<LineRange> out;
+    out.reserve(ranges.size() + 1);
+    for (const LineRange& r : ranges) {
+        // Part before the replaced block keeps its rows...
+        if (r.begin < change.row) out.push_back({r.begin, std::min(r.end, change.row)});
+        // ...part after it shifts; anything inside it is gone.
+        if (r.end > replacedEnd) out.push_back({std::max(r.begin, replacedEnd) + shift, r.end + shift});
+    }
+    return out;
+}
+
+void LineRangeSet::add(LineRange range) {
+    if (range.begin >= range.end) return;
+    // Absorb every existing range that overlaps or touches the new one.
+    auto first = std::lower_bound(ranges_.begin(), ranges_.end(), range.begin,
+                                  [](const LineRange& r, Row row) { return r.end < row; });
+    auto last = first;
+    while (last != ranges_.end() && last->begin <= range.end) {
+        range.begin = std::min(range.begin, last->begin);
+        range.end = std::max(range.end, last->end);
+        ++last;
+    }
+    first = ranges_.erase(first, last);
+    ranges_.insert(first, range);
+}
+
+void LineRangeSet::remove(LineRange range) {
+    if (range.begin >= range.end) return;
+    std::vector<LineRange> kept;
+    kept.reserve(ranges_.size() + 1);
+    for (const LineRange& r : ranges_) {
+        if (r.end <= range.begin || r.begin >= range.end) {
+            kept.push_back(r);
+            continue;
+        }
+        if (r.begin < range.begin) kept.push_back({r.begin, range.begin});
+        if (r.end > range.end) kept.push_back({range.end, r.end});
+    }
+    ranges_ = std::move(kept);
+}
+
+void LineRangeSet::applyChange(const LineChange& change) {
+    std::vector<LineRange> shifted = remapRanges(ranges_, change);
+    ranges_.clear();
+    for (const LineRange& r : shifted) add(r);
+    add({change.row, change.row + change.inserted});
+}
+
+bool LineRangeSet::contains(Row row) const {
+    auto it = std::upper_bound(ranges_.begin(), ranges_.end(), row,
+                               [](Row row, const LineRange& r) { return row < r.end; });
+    return it != ranges_.end() && it->begin <= row;
+}
+
+} // namespace editor
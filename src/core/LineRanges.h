@@ -0,0 +1,50 @@
+#pragma once
+#include <vector>
+
+#include "core/Position.h"
+
+namespace editor {
+
+// One structural edit in row terms: rows [row, row+removed) of the old text
+// were replaced by rows [row, row+inserted) of the new text. Every row after
+// the replaced block moved by (inserted - removed). An in-line edit is
+// {row, 1, 1}; typing a newline is {row, 1, 2}.
+struct LineChange {
+    Row row;
+    Row removed;
+    Row inserted;
+};
+
+// Half-open row range [begin, end).
+struct LineRange {
+    Row begin;
+    Row end;
+};
+
+// Maps `row` through `change`. Returns false if the row was part of the
+// replaced block (its old content no longer exists).
+bool remapRow(Row& row, const LineChange& change);
+
+// The parts of `ranges` that survived `change`, in new-row coordinates.
+std::vector<LineRange> remapRanges(const std::vector<LineRange>& ranges, const LineChange& change);
+
+// Sorted, non-overlapping set of rows - used to track which rows still need
+// spell checking while edits keep shifting row numbers underneath it.
+class LineRangeSet {
+public:
+    void add(LineRange range);
+    void remove(LineRange range);
+    // Drops rows the change replaced, shifts the rows after it, and marks
+    // the change's new rows as members.
+    void applyChange(const LineChange& change);
+    void clear() { ranges_.clear(); }
+
+    bool empty() const { return ranges_.empty(); }
+    bool contains(Row row) const;
+    const std::vector<LineRange>& ranges() const { return ranges_; }
+
+private:
+    std::vector<LineRange> ranges_;
+};
+
+} // namespace editor
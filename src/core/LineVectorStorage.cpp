@@ -0,0 +1,65 @@
+#include "core/LineVectorStorage.h"
+
+#include <iterator>
+
+namespace editor {
+
+void LineVectorStorage::appendText(TextBlock text) {
+    std::vector<std::string> more = splitLines(text.data.get(), text.size);
+    lines_.back() += more.front();
+    lines_.insert(lines_.end(), std::make_move_iterator(more.begin() + 1), std::make_move_iterator(more.end()));
+}
+
+void LineVectorStorage::insert(Position at, const std::string& text) {
+    std::vector<std::string> parts;
+    size_t segStart = 0;
+    for (size_t i = 0; i <= text.size(); ++i) {
+        if (i == text.size() || text[i] == '\n') {
+            parts.push_back(text.substr(segStart, i - segStart));
+            segStart = i + 1;
+        }
+    }
+
+    std::string& line = lines_[at.row];
+    std::string suffix = line.substr(at.col);
+    line = line.substr(0, at.col) + parts.front();
+
+    if (parts.size() == 1) {
+        line += suffix;
+    } else {
+        std::vector<std::string> newLines;
+        for (size_t i = 1; i + 1 < parts.size(); ++i) newLines.push_back(parts[i]);
+        newLines.push_back(parts.back() + suffix);
+        lines_.insert(lines_.begin() + at.row + 1, newLines.begin(), newLines.end());
+    }
+}
+
+std::string LineVectorStorage::erase(Position from, Position to) {
+    std::string erased;
+    if (from.row == to.row) {
+        erased = lines_[from.row].substr(from.col, to.col - from.col);
+        lines_[from.row].erase(from.col, to.col - from.col);
+    } else {
+        erased = lines_[from.row].substr(from.col);
+        for (Row r = from.row + 1; r < to.row; ++r) {
+            erased += "\n" + lines_[r];
+        }
+        erased += "\n" + lines_[to.row].substr(0, to.col);
+
+        lines_[from.row] = lines_[from.row].substr(0, from.col) + lines_[to.row].substr(to.col);
+        lines_.erase(lines_.begin() + from.row + 1, lines_.begin() + to.row + 1);
+    }
+    return erased;
+}
+
+std::string LineVectorStorage::text(Position from, Position to) const {
+    if (from.row == to.row) {
+        return lines_[from.row].substr(from.col, to.col - from.col);
+    }
+    std::string result = lines_[from.row].substr(from.col);
+    for (Row r = from.row + 1; r < to.row; ++r) result += "\n" + lines_[r];
+    result += "\n" + lines_[to.row].substr(0, to.col);
+    return result;
+}
+
+} // namespace editor
@@ -0,0 +1,42 @@
+#pragma once
+#include <string>
+#include <vector>
+
+#include "core/Newlines.h"
+#include "core/TextSnapshot.h"
+#include "core/TextStorage.h"
+
+namespace editor {
+
+// The original storage: one std::string per line. Simple and fast for small
+// files, but an insert splits and rebuilds the line and a newline shifts
+// every following line, so edit cost grows with the file.
+class LineVectorStorage : public TextStorage {
+public:
+    LineVectorStorage() { lines_.push_back(""); }
+
+    Row lineCount() const override { return static_cast<Row>(lines_.size()); }
+    int lineLength(Row row) const override { return static_cast<int>(lines_[row].size()); }
+    std::string line(Row row) const override { return lines_[row]; }
+    void forEachLine(Row first, Row last, const LineVisitor& visit) const override {
+        for (Row r = first; r < last; ++r) visit(r, lines_[r]);
+    }
+
+    void insert(Position at, const std::string& text) override;
+    std::string erase(Position from, Position to) override;
+    std::string text(Position from, Position to) const override;
+    void load(std::vector<std::string> lines) override { lines_ = std::move(lines); }
+    void loadText(TextBlock text) override { lines_ = splitLines(text.data.get(), text.size); }
+    void appendText(TextBlock text) override;
+
+    // A deep copy - O(document). This backend is the baseline the piece
+    // table's shared snapshots are measured against.
+    std::shared_ptr<const TextSnapshot> snapshot() const override {
+        return std::make_shared<LineVectorSnapshot>(lines_);
+    }
+
+private:
+    std::vector<std::string> lines_;
+};
+
+} // namespace editor
@@ -0,0 +1,96 @@
+#include "core/Newlines.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define EDITOR_X86 1
+#endif
+
+namespace editor {
+
+#ifdef EDITOR_X86
+namespace {
+// Each compare yields 0xff per matching byte; subtracting that from a
+// vector of byte counters adds one per newline. After at most 255 rounds
+// the counters are folded into 64-bit sums (psadbw) before they can wrap.
+size_t countSse2(const char* data, size_t len) {
+    const __m128i nl = _mm_set1_epi8('\n');
+    size_t total = 0, i = 0;
+    while (len - i >= 16) {
+        __m128i counts = _mm_setzero_si128();
+        size_t rounds = std::min<size_t>((len - i) / 16, 255);
+        for (size_t r = 0; r < rounds; ++r, i += 16) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+            counts = _mm_sub_epi8(counts, _mm_cmpeq_epi8(v, nl));
+        }
+        __m128i sums = _mm_sad_epu8(counts, _mm_setzero_si128());
+        total += static_cast<size_t>(_mm_cvtsi128_si64(sums)) +
+                 static_cast<size_t>(_mm_cvtsi128_si64(_mm_unpackhi_epi64(sums, sums)));
+    }
+    return total + countNewlinesScalar(data + i, len - i);
+}
+
+__attribute__((target("avx2"))) size_t countAvx2(const char* data, size_t len) {
+    const __m256i nl = _mm256_set1_epi8('\n');
+    size_t total = 0, i = 0;
+    while (len - i >= 32) {
+        __m256i counts = _mm256_setzero_si256();
+        size_t rounds = std::min<size_t>((len - i) / 32, 255);
+        for (size_t r = 0; r < rounds; ++r, i += 32) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+            counts = _mm256_sub_epi8(counts, _mm256_cmpeq_epi8(v, nl));
+        }
+        __m256i sums = _mm256_sad_epu8(counts, _mm256_setzero_si256());
+        alignas(32) uint64_t lanes[4];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), sums);
+        total += lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    }
+    return total + countSse2(data + i, len - i);
+}
+
+using CountFn = size_t (*)(const char*, size_t);
+
+CountFn pickCount() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") ? countAvx2 : countSse2;
+}
+} // namespace
+#endif
+
+size_t countNewlinesScalar(const char* data, size_t len) {
+    return static_cast<size_t>(std::count(data, data + len, '\n'));
+}
+
+size_t countNewlines(const char* data, size_t len) {
+#ifdef EDITOR_X86
+    static const CountFn count = pickCount();
+    return count(data, len);
+#else
+    return countNewlinesScalar(data, len);
+#endif
+}
+
+void countNewlinesPerGranule(const char* data, size_t len, uint16_t* out) {
+    for (size_t off = 0; off < len; off += kTextBlockGranule) {
+        *out++ = static_cast<uint16_t>(countNewlines(data + off, std::min(kTextBlockGranule, len - off)));
+    }
+}
+
+std::vector<std::string> splitLines(const char* data, size_t len) {
+    std::vector<std::string> lines;
+    lines.reserve(countNewlines(data, len) + 1);
+    const char* p = data;
+    const char* end = data + len;
+    while (const void* nl = p == end ? nullptr : std::memchr(p, '\n', static_cast<size_t>(end - p))) {
+        const char* at = static_cast<const char*>(nl);
+        lines.emplace_back(p, at);
+        p = at + 1;
+    }
+    lines.emplace_back(p, end);
+    return lines;
+}
+
+} // namespace editor
@@ -0,0 +1,30 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "core/TextBlock.h"
+
+namespace editor {
+
+// Number of '\n' bytes in [data, data + len). This is what loading spends
+// its time on - the piece table counts the line feeds of every piece - so it
+// compares 32 bytes at a time with AVX2 when the CPU has it, 16 with SSE2
+// otherwise on x86-64, and falls back to a plain loop elsewhere.
+size_t countNewlines(const char* data, size_t len);
+
+// Fills `out` with the newline count of each kTextBlockGranule bytes of
+// [data, data + len) - ceil(len / kTextBlockGranule) entries, the
+// TextBlock::newlines index. `data` must start on a granule boundary of
+// the text being indexed for the counts to line up.
+void countNewlinesPerGranule(const char* data, size_t len, uint16_t* out);
+
+// The portable loop countNewlines() falls back to; for tests and benchmarks.
+size_t countNewlinesScalar(const char* data, size_t len);
+
+// [data, data + len) cut at each '\n' (always at least one line). memchr
+// is vectorized already, so the scan between copies runs at memory speed.
+std::vector<std::string> splitLines(const char* data, size_t len);
+
+} // namespace editor
@@ -0,0 +1,392 @@
+#include "core/PieceTable.h"
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+#include "core/Newlines.h"
+
+namespace editor {
+
+namespace {
+// Typed text goes into blocks of this size; a paste larger than a block gets
+// a block of its own. Blocks are never reallocated, so pieces can point
+// straight into them.
+constexpr size_t kAddBlockBytes = 64 * 1024;
+
+size_t countLineFeeds(const char* data, size_t len) {
+    return countNewlines(data, len);
+}
+} // namespace
+
+// A frozen root plus shared ownership of every buffer it may point into.
+// Copying the block list is O(add blocks), which is O(1) in the size of the
+// document; nothing the snapshot can see is ever written to again.
+class PieceTable::Snapshot : public TextSnapshot {
+public:
+    Snapshot(NodePtr root, std::vector<std::shared_ptr<const char>> originals,
+             std::vector<std::shared_ptr<char[]>> addBlocks)
+        : root_(std::move(root)), originals_(std::move(originals)), addBlocks_(std::move(addBlocks)) {}
+    using TextSnapshot::forEachLine;
+
+    Row lineCount() const override { return PieceTable::lineCount(root_.get()); }
+    std::string line(Row row) const override {
+        return collect(root_.get(), lineStart(root_.get(), row), lineEnd(root_.get(), row));
+    }
+    void forEachLine(Row first, Row last, const LineVisitor& visit) const override {
+        PieceTable::forEachLine(root_.get(), first, last, visit);
+    }
+    void forEachRun(const RunVisitor& visit) const override { PieceTable::forEachRun(root_.get(), visit); }
+
+private:
+    NodePtr root_;
+    std::vector<std::shared_ptr<const char>> originals_;
+    std::vector<std::shared_ptr<char[]>> addBlocks_;
+};
+
+PieceTable::PieceTable(size_t loadPieceBytes) : loadPieceBytes_(loadPieceBytes) {}
+PieceTable::~PieceTable() = default;
+
+uint32_t PieceTable::nextPriority() {
+    // xorshift32 - treap priorities only need to be well spread, not secure.
+    rngState_ ^= rngState_ << 13;
+    rngState_ ^= rngState_ >> 17;
+    rngState_ ^= rngState_ << 5;
+    return rngState_;
+}
+
+PieceTable::NodePtr PieceTable::makeNode(const Piece& piece, uint32_t priority, NodePtr left, NodePtr right) {
+    size_t len = piece.length;
+    size_t feeds = piece.lineFeeds;
+    size_t pieces = 1;
+    for (const Node* child : {left.get(), right.get()}) {
+        if (!child) continue;
+        len += child->subtreeLength;
+        feeds += child->subtreeLineFeeds;
+        pieces += child->subtreePieces;
+    }
+    return std::make_shared<const Node>(Node{piece, priority, std::move(left), std::move(right), len, feeds, pieces});
+}
+
+PieceTable::Piece PieceTable::slice(const Piece& p, size_t from, size_t to) {
+    return {p.data + from, to - from, countLineFeeds(p.data + from, to - from)};
+}
+
+PieceTable::NodePtr PieceTable::merge(const NodePtr& a, const NodePtr& b) {
+    if (!a) return b;
+    if (!b) return a;
+    if (a->priority > b->priority) {
+        return makeNode(a->piece, a->priority, a->left, merge(a->right, b));
+    }
+    return makeNode(b->piece, b->priority, merge(a, b->left), b->right);
+}
+
+// Splits `n` into the first `offset` bytes and the rest, cutting a piece in
+// two when the offset falls inside it. `n` itself is left untouched.
+std::pair<PieceTable::NodePtr, PieceTable::NodePtr> PieceTable::split(const NodePtr& n, size_t offset) {
+    if (!n) return {nullptr, nullptr};
+    size_t leftLen = n->left ? n->left->subtreeLength : 0;
+    size_t pieceEnd = leftLen + n->piece.length;
+
+    if (offset <= leftLen) {
+        auto [l, r] = split(n->left, offset);
+        return {l, makeNode(n->piece, n->priority, r, n->right)};
+    }
+    if (offset >= pieceEnd) {
+        auto [l, r] = split(n->right, offset - pieceEnd);
+        return {makeNode(n->piece, n->priority, n->left, l), r};
+    }
+    size_t cut = offset - leftLen;
+    NodePtr head = makeNode(slice(n->piece, 0, cut), n->priority, n->left, nullptr);
+    NodePtr tail = makeNode(slice(n->piece, cut, n->piece.length), nextPriority(), nullptr, nullptr);
+    return {head, merge(tail, n->right)};
+}
+
+// Builds a treap over `pieces` (in document order) in O(n) with the usual
+// right-spine stack construction of a Cartesian tree. Nodes are immutable,
+// so the spine is kept as (piece, priority, left subtree) until each node's
+// right subtree is final.
+PieceTable::NodePtr PieceTable::buildTree(const std::vector<Piece>& pieces) {
+    struct Pending {
+        Piece piece;
+        uint32_t priority;
+        NodePtr left;
+    };
+    std::vector<Pending> spine;
+    for (const Piece& p : pieces) {
+        uint32_t priority = nextPriority();
+        NodePtr chain;
+        while (!spine.empty() && spine.back().priority < priority) {
+            Pending& top = spine.back();
+            chain = makeNode(top.piece, top.priority, std::move(top.left), std::move(chain));
+            spine.pop_back();
+        }
+        spine.push_back({p, priority, std::move(chain)});
+    }
+
+    NodePtr chain;
+    while (!spine.empty()) {
+        Pending& top = spine.back();
+        chain = makeNode(top.piece, top.priority, std::move(top.left), std::move(chain));
+        spine.pop_back();
+    }
+    return chain;
+}
+
+const char* PieceTable::appendToAddBuffer(const std::string& text) {
+    if (addBlocks_.empty() || text.size() > addCapacity_ - addUsed_) {
+        addCapacity_ = std::max(kAddBlockBytes, text.size());
+        addBlocks_.emplace_back(new char[addCapacity_]);
+        addUsed_ = 0;
+    }
+    char* dest = addBlocks_.back().get() + addUsed_;
+    std::memcpy(dest, text.data(), text.size());
+    addUsed_ += text.size();
+    return dest;
+}
+
+// Typing appends to the add buffer right after the previous keystroke, so
+// the piece ending at the insertion point usually ends exactly where the new
+// text begins. Growing that piece (a copy of it - snapshots may still hold
+// the old one) keeps a run of typing as a single piece instead of one piece
+// per character. Returns null when the rightmost piece can't be extended.
+PieceTable::NodePtr PieceTable::extendRightmost(const NodePtr& n, const char* data, size_t len,
+                                                size_t lineFeeds) {
+    if (n->right) {
+        NodePtr right = extendRightmost(n->right, data, len, lineFeeds);
+        return right ? makeNode(n->piece, n->priority, n->left, std::move(right)) : nullptr;
+    }
+    if (n->piece.data + n->piece.length != data || n->piece.length + len > kMaxPieceBytes) return nullptr;
+    Piece grown{n->piece.data, n->piece.length + len, n->piece.lineFeeds + lineFeeds};
+    return makeNode(grown, n->priority, n->left, nullptr);
+}
+
+Row PieceTable::lineCount(const Node* root) {
+    return static_cast<Row>((root ? root->subtreeLineFeeds : 0) + 1);
+}
+
+size_t PieceTable::length(const Node* root) {
+    return root ? root->subtreeLength : 0;
+}
+
+// Byte offset of the k-th (1-based) newline in the document. The pieces'
+// counts are trusted to find the piece, but not within it: an original
+// buffer is a mapping of the user's file, which another program can rewrite
+// underneath (see MappedFile). A newline that is no longer there is taken
+// to be at the end of its piece, so lines come out wrong but in bounds.
+size_t PieceTable::newlineOffset(const Node* n, size_t k) {
+    const Node* root = n;
+    size_t base = 0;
+    while (n) {
+        size_t leftLen = n->left ? n->left->subtreeLength : 0;
+        size_t leftFeeds = n->left ? n->left->subtreeLineFeeds : 0;
+        if (k <= leftFeeds) {
+            n = n->left.get();
+            continue;
+        }
+        k -= leftFeeds;
+        if (k <= n->piece.lineFeeds) {
+            const char* p = n->piece.data;
+            const char* end = p + n->piece.length;
+            for (;;) {
+                const char* nl = static_cast<const char*>(std::memchr(p, '\n', end - p));
+                if (!nl) return base + leftLen + n->piece.length;
+                if (--k == 0) return base + leftLen + (nl - n->piece.data);
+                p = nl + 1;
+            }
+        }
+        k -= n->piece.lineFeeds;
+        base += leftLen + n->piece.length;
+        n = n->right.get();
+    }
+    return length(root);
+}
+
+size_t PieceTable::lineStart(const Node* root, Row row) {
+    return row == 0 ? 0 : std::min(newlineOffset(root, static_cast<size_t>(row)) + 1, length(root));
+}
+
+size_t PieceTable::lineEnd(const Node* root, Row row) {
+    return row + 1 < lineCount(root) ? newlineOffset(root, static_cast<size_t>(row) + 1) : length(root);
+}
+
+// Calls fn(data, len) for every piece slice overlapping [from, to), in
+// document order, descending only into subtrees that overlap the range.
+template <typename Fn>
+void PieceTable::visitRange(const Node* n, size_t base, size_t from, size_t to, Fn& fn) {
+    if (!n) return;
+    size_t nodeStart = base + (n->left ? n->left->subtreeLength : 0);
+    size_t nodeEnd = nodeStart + n->piece.length;
+    if (from < nodeStart) visitRange(n->left.get(), base, from, to, fn);
+    size_t s = std::max(from, nodeStart);
+    size_t e = std::min(to, nodeEnd);
+    if (s < e) fn(n->piece.data + (s - nodeStart), e - s);
+    if (to > nodeEnd) visitRange(n->right.get(), nodeEnd, from, to, fn);
+}
+
+std::string PieceTable::collect(const Node* root, size_t from, size_t to) {
+    std::string out;
+    if (to <= from) return out; // a row whose newlines changed on disk; see newlineOffset()
+    out.reserve(to - from);
+    auto append = [&out](const char* data, size_t len) { out.append(data, len); };
+    visitRange(root, 0, from, to, append);
+    return out;
+}
+
+// Lines that sit inside a single piece are handed to `visit` as views
+// straight into the buffer; only lines spanning pieces are assembled.
+void PieceTable::forEachLine(const Node* root, Row first, Row last, const LineVisitor& visit) {
+    if (first >= last) return;
+    Row row = first;
+    std::string pending;
+    auto emit = [&](const char* data, size_t len) {
+        const char* end = data + len;
+        // Past `last` only if the text has more newlines than its pieces
+        // counted - changed on disk under them.
+        while (data < end && row < last) {
+            const char* nl = static_cast<const char*>(std::memchr(data, '\n', end - data));
+            if (!nl) {
+                pending.append(data, end - data);
+                return;
+            }
+            if (pending.empty()) {
+                visit(row++, std::string_view(data, nl - data));
+            } else {
+                pending.append(data, nl - data);
+                visit(row++, pending);
+                pending.clear();
+            }
+            data = nl + 1;
+        }
+    };
+    visitRange(root, 0, lineStart(root, first), lineEnd(root, last - 1), emit);
+    if (row < last) visit(row, pending);
+}
+
+// Piece by piece: untouched text straight from the original buffer (the
+// mapping), edits from the add buffer.
+void PieceTable::forEachRun(const Node* root, const RunVisitor& visit) {
+    auto run = [&visit](const char* data, size_t len) { visit(std::string_view(data, len)); };
+    visitRange(root, 0, 0, length(root), run);
+}
+
+size_t PieceTable::offsetOf(Position p) const {
+    return lineStart(root_.get(), p.row) + static_cast<size_t>(p.col);
+}
+
+Row PieceTable::lineCount() const {
+    return lineCount(root_.get());
+}
+
+size_t PieceTable::length() const {
+    return length(root_.get());
+}
+
+size_t PieceTable::pieceCount() const {
+    return root_ ? root_->subtreePieces : 0;
+}
+
+int PieceTable::lineLength(Row row) const {
+    size_t start = lineStart(root_.get(), row), end = lineEnd(root_.get(), row);
+    return end > start ? static_cast<int>(end - start) : 0;
+}
+
+std::string PieceTable::line(Row row) const {
+    return collect(root_.get(), lineStart(root_.get(), row), lineEnd(root_.get(), row));
+}
+
+std::string PieceTable::text(Position from, Position to) const {
+    return collect(root_.get(), offsetOf(from), offsetOf(to));
+}
+
+void PieceTable::insert(Position at, const std::string& text) {
+    if (text.empty()) return;
+
+    auto [left, right] = split(root_, offsetOf(at));
+
+    bool fitsInBlock = !addBlocks_.empty() && text.size() <= addCapacity_ - addUsed_;
+    size_t lineFeeds = countLineFeeds(text.data(), text.size());
+    const char* data = appendToAddBuffer(text);
+
+    NodePtr extended = fitsInBlock && left ? extendRightmost(left, data, text.size(), lineFeeds) : nullptr;
+    if (extended) {
+        left = std::move(extended);
+    } else {
+        std::vector<Piece> pieces;
+        for (size_t off = 0; off < text.size(); off += kMaxPieceBytes) {
+            size_t len = std::min(kMaxPieceBytes, text.size() - off);
+            pieces.push_back({data + off, len, countLineFeeds(data + off, len)});
+        }
+        left = merge(left, buildTree(pieces));
+    }
+    root_ = merge(left, right);
+}
+
+std::string PieceTable::erase(Position from, Position to) {
+    size_t a = offsetOf(from);
+    size_t b = offsetOf(to);
+
+    auto [left, rest] = split(root_, a);
+    auto [middle, right] = split(rest, b - a);
+    std::string erased = collect(middle.get(), 0, b - a);
+    root_ = merge(left, right);
+    return erased;
+}
+
+void PieceTable::load(std::vector<std::string> lines) {
+    size_t total = lines.size() - 1;
+    for (const auto& l : lines) total += l.size();
+
+    std::shared_ptr<char[]> joined(new char[total]);
+    char* p = joined.get();
+    for (size_t i = 0; i < lines.size(); ++i) {
+        if (i > 0) *p++ = '\n';
+        std::memcpy(p, lines[i].data(), lines[i].size());
+        p += lines[i].size();
+    }
+    loadText({std::shared_ptr<const char>(joined, joined.get()), total});
+}
+
+// One piece per loadPieceBytes_ of `text`, their line feeds summed from its
+// newline index when it has one.
+PieceTable::NodePtr PieceTable::buildTree(const TextBlock& text) {
+    size_t total = text.size;
+    std::vector<Piece> pieces;
+    pieces.reserve(total / loadPieceBytes_ + 1);
+    bool indexed = text.newlines.size() == (total + kTextBlockGranule - 1) / kTextBlockGranule;
+    for (size_t off = 0; off < total; off += loadPieceBytes_) {
+        size_t len = std::min(loadPieceBytes_, total - off);
+        const char* data = text.data.get() + off;
+        size_t lineFeeds;
+        if (indexed) {
+            auto first = text.newlines.begin() + static_cast<std::ptrdiff_t>(off / kTextBlockGranule);
+            auto last = first + static_cast<std::ptrdiff_t>((len + kTextBlockGranule - 1) / kTextBlockGranule);
+            lineFeeds = std::accumulate(first, last, size_t(0));
+        } else {
+            lineFeeds = countLineFeeds(data, len);
+        }
+        pieces.push_back({data, len, lineFeeds});
+    }
+    return buildTree(pieces);
+}
+
+void PieceTable::loadText(TextBlock text) {
+    addBlocks_.clear();
+    addUsed_ = 0;
+    addCapacity_ = 0;
+
+    root_ = buildTree(text);
+    originals_.assign(1, std::move(text.data));
+}
+
+void PieceTable::appendText(TextBlock text) {
+    if (text.size == 0) return;
+    root_ = merge(root_, buildTree(text));
+    originals_.push_back(std::move(text.data));
+}
+
+std::shared_ptr<const TextSnapshot> PieceTable::snapshot() const {
+    return std::make_shared<Snapshot>(root_, originals_, addBlocks_);
+}
+
+} // namespace editor
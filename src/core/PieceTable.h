@@ -0,0 +1,124 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "core/TextStorage.h"
+
+namespace editor {
+
+// Piece-table storage: the loaded text lives in one immutable `original`
+// buffer (for a file, its read-only mapping - or, while the file is
+// still streaming in, several consecutive slices of it), everything typed or pasted is appended to an append-only `add`
+// buffer, and the document is the in-order sequence of pieces (slices of
+// those two buffers) held in a treap. Each node caches its subtree's byte
+// length and newline count, so mapping a row to a byte offset and splitting
+// or joining the sequence at an offset are O(log pieces) no matter how large
+// the file is.
+//
+// Pieces are capped at kMaxPieceBytes so that locating a newline inside a
+// piece, or splitting one in two, is a bounded scan. For a large file
+// (StorageKind::LargeFile) loaded text is cut into kLargeFilePieceBytes
+// pieces instead: the tree - the table's only per-file memory, one node
+// per piece - then stays a few megabytes however big the mapping is, at
+// the price of longer (still vectorized) scans inside a piece.
+//
+// Nodes are immutable and shared: an edit copies only the O(log pieces)
+// nodes on the paths it touches and reuses every other subtree. Bytes
+// already written to the buffers are never modified either, so snapshot()
+// is just the current root plus references to the buffers - O(1) in the
+// size of the document - and stays valid however the table is edited later.
+class PieceTable : public TextStorage {
+public:
+    static constexpr size_t kMaxPieceBytes = kTextBlockGranule;
+    static constexpr size_t kLargeFilePieceBytes = size_t(1) << 20;
+
+    // `loadPieceBytes`, a multiple of kTextBlockGranule, is the size loaded
+    // and appended text is cut into.
+    explicit PieceTable(size_t loadPieceBytes = kMaxPieceBytes);
+    ~PieceTable() override;
+
+    Row lineCount() const override;
+    int lineLength(Row row) const override;
+    std::string line(Row row) const override;
+    void forEachLine(Row first, Row last, const LineVisitor& visit) const override {
+        forEachLine(root_.get(), first, last, visit);
+    }
+
+    void insert(Position at, const std::string& text) override;
+    std::string erase(Position from, Position to) override;
+    std::string text(Position from, Position to) const override;
+    void load(std::vector<std::string> lines) override;
+    // `text` becomes the original buffer as is - nothing is copied - and
+    // its newline index, if it has one, the pieces' line-feed counts.
+    void loadText(TextBlock text) override;
+    // Adds `text` as more original text: its pieces go after the last one,
+    // and it is kept alive alongside the rest.
+    void appendText(TextBlock text) override;
+    std::shared_ptr<const TextSnapshot> snapshot() const override;
+
+    size_t length() const;
+    size_t pieceCount() const;
+
+private:
+    struct Piece {
+        const char* data;
+        size_t length;
+        size_t lineFeeds;
+    };
+
+    struct Node;
+    using NodePtr = std::shared_ptr<const Node>;
+    struct Node {
+        Piece piece;
+        uint32_t priority;
+        NodePtr left;
+        NodePtr right;
+        size_t subtreeLength;
+        size_t subtreeLineFeeds;
+        size_t subtreePieces;
+    };
+
+    class Snapshot;
+
+    // Keeps the buffers alive for as long as any tree (live or snapshot)
+    // may still point into them.
+    std::vector<std::shared_ptr<const char>> originals_; // loaded, then appended
+    std::vector<std::shared_ptr<char[]>> addBlocks_;
+    size_t addUsed_ = 0;     // bytes written into addBlocks_.back()
+    size_t addCapacity_ = 0; // size of addBlocks_.back()
+    NodePtr root_;
+    size_t loadPieceBytes_;
+    uint32_t rngState_ = 0x9e3779b9u;
+
+    uint32_t nextPriority();
+    static NodePtr makeNode(const Piece& piece, uint32_t priority, NodePtr left, NodePtr right);
+    static Piece slice(const Piece& p, size_t from, size_t to);
+
+    static NodePtr merge(const NodePtr& a, const NodePtr& b);
+    std::pair<NodePtr, NodePtr> split(const NodePtr& n, size_t offset);
+    NodePtr buildTree(const std::vector<Piece>& pieces);
+    NodePtr buildTree(const TextBlock& text);
+
+    const char* appendToAddBuffer(const std::string& text);
+    static NodePtr extendRightmost(const NodePtr& n, const char* data, size_t len, size_t lineFeeds);
+
+    // Read-only queries, shared with Snapshot.
+    static Row lineCount(const Node* root);
+    static size_t length(const Node* root);
+    static size_t newlineOffset(const Node* root, size_t k);
+    static size_t lineStart(const Node* root, Row row);
+    static size_t lineEnd(const Node* root, Row row);
+    static std::string collect(const Node* root, size_t from, size_t to);
+    template <typename Fn>
+    static void visitRange(const Node* n, size_t base, size_t from, size_t to, Fn& fn);
+    static void forEachLine(const Node* root, Row first, Row last, const LineVisitor& visit);
+    static void forEachRun(const Node* root, const RunVisitor& visit);
+
+    size_t offsetOf(Position p) const;
+};
+
+} // namespace editor
@@ -0,0 +1,21 @@
+#pragma once
+#include <cstdint>
+
+namespace editor {
+
+// Rows are 64-bit: a large file (see StorageKind::LargeFile) can have more
+// than 2^31 lines. Columns stay int - no line is ever that long.
+using Row = int64_t;
+
+struct Position {
+    Row row = 0;
+    int col = 0;
+};
+
+inline bool operator==(const Position& a, const Position& b) { return a.row == b.row && a.col == b.col; }
+inline bool operator!=(const Position& a, const Position& b) { return !(a == b); }
+inline bool operator<(const Position& a, const Position& b) {
+    return a.row != b.row ? a.row < b.row : a.col < b.col;
+}
+
+} // namespace editor
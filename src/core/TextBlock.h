@@ -0,0 +1,29 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace editor {
+
+// Text as one contiguous read-only block: lines separated by '\n', with no
+// '\n' after the last one. `data` owns whatever holds the bytes - for a
+// loaded file, the read-only mapping of it - so a block can go from the
+// loader through the event queue into a piece table without being copied.
+struct TextBlock {
+    std::shared_ptr<const char> data;
+    size_t size = 0;
+    // Optional newline index: the number of '\n' in each kTextBlockGranule
+    // bytes of the text, in order (the last slice may be shorter). A loader
+    // that has already scanned the text fills it in, so the storage it is
+    // handed to doesn't scan it again; empty means "not counted".
+    std::vector<uint16_t> newlines{};
+};
+
+// Granularity of TextBlock::newlines - the piece size of
+// StorageKind::PieceTable, where a count is exactly one piece's line feeds.
+// A StorageKind::LargeFile piece (PieceTable::kLargeFilePieceBytes, a
+// multiple of this) sums the counts of the granules it spans.
+constexpr size_t kTextBlockGranule = 4096;
+
+} // namespace editor
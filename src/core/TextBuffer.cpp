@@ -2,6 +2,11 @@
 
 #include <algorithm>
 #include <cctype>
+#include <string_view>
+#include <utility>
+
+#include "core/LineVectorStorage.h"
+#include "core/PieceTable.h"
 
 namespace editor {
 
@@ -18,14 +23,20 @@ Position advance(Position start, const std::string& text) {
     return p;
 }
 
-TextBuffer::TextBuffer() {
-    lines_.push_back("");
+std::unique_ptr<TextStorage> makeStorage(StorageKind kind) {
+    switch (kind) {
+        case StorageKind::LineVector: return std::make_unique<LineVectorStorage>();
+        case StorageKind::LargeFile: return std::make_unique<PieceTable>(PieceTable::kLargeFilePieceBytes);
+        case StorageKind::PieceTable: break;
+    }
+    return std::make_unique<PieceTable>();
 }
 
+TextBuffer::TextBuffer(StorageKind kind) : storage_(makeStorage(kind)), kind_(kind) {}
+
 Position TextBuffer::clampPosition(Position p) const {
-    if (lines_.empty()) return {0, 0};
-    p.row = std::clamp(p.row, 0, static_cast<int>(lines_.size()) - 1);
-    p.col = std::clamp(p.col, 0, static_cast<int>(lines_[p.row].size()));
+    p.row = std::clamp<Row>(p.row, 0, lineCount() - 1);
+    p.col = std::clamp(p.col, 0, lineLength(p.row));
     return p;
 }
 
@@ -39,13 +50,13 @@ void TextBuffer::moveLeft() {
         cursor_.col--;
     } else if (cursor_.row > 0) {
         cursor_.row--;
-        cursor_.col = static_cast<int>(lines_[cursor_.row].size());
+        cursor_.col = lineLength(cursor_.row);
     }
     desiredCol_ = cursor_.col;
 }
 
 void TextBuffer::moveRight() {
-    if (cursor_.col < static_cast<int>(lines_[cursor_.row].size())) {
+    if (cursor_.col < lineLength(cursor_.row)) {
         cursor_.col++;
     } else if (cursor_.row + 1 < lineCount()) {
         cursor_.row++;
@@ -57,14 +68,14 @@ void TextBuffer::moveRight() {
 void TextBuffer::moveUp() {
     if (cursor_.row > 0) {
         cursor_.row--;
-        cursor_.col = std::min(desiredCol_, static_cast<int>(lines_[cursor_.row].size()));
+        cursor_.col = std::min(desiredCol_, lineLength(cursor_.row));
     }
 }
 
 void TextBuffer::moveDown() {
     if (cursor_.row + 1 < lineCount()) {
         cursor_.row++;
-        cursor_.col = std::min(desiredCol_, static_cast<int>(lines_[cursor_.row].size()));
+        cursor_.col = std::min(desiredCol_, lineLength(cursor_.row));
     }
 }
 
@@ -74,48 +85,26 @@ void TextBuffer::moveHome() {
 }
 
 void TextBuffer::moveEnd() {
-    cursor_.col = static_cast<int>(lines_[cursor_.row].size());
+    cursor_.col = lineLength(cursor_.row);
     desiredCol_ = cursor_.col;
 }
 
 void TextBuffer::movePageUp(int pageSize) {
-    cursor_.row = std::max(0, cursor_.row - pageSize);
-    cursor_.col = std::min(desiredCol_, static_cast<int>(lines_[cursor_.row].size()));
+    cursor_.row = std::max<Row>(0, cursor_.row - pageSize);
+    cursor_.col = std::min(desiredCol_, lineLength(cursor_.row));
 }
 
 void TextBuffer::movePageDown(int pageSize) {
-    cursor_.row = std::min(lineCount() - 1, cursor_.row + pageSize);
-    cursor_.col = std::min(desiredCol_, static_cast<int>(lines_[cursor_.row].size()));
+    cursor_.row = std::min<Row>(lineCount() - 1, cursor_.row + pageSize);
+    cursor_.col = std::min(desiredCol_, lineLength(cursor_.row));
 }
 
 Position TextBuffer::insertText(Position at, const std::string& text) {
     at = clampPosition(at);
+    storage_->insert(at, text);
 
-    std::vector<std::string> parts;
-    size_t segStart = 0;
-    for (size_t i = 0; i <= text.size(); ++i) {
-        if (i == text.size() || text[i] == '\n') {
-            parts.push_back(text.substr(segStart, i - segStart));
-            segStart = i + 1;
-        }
-    }
-
-    std::string& line = lines_[at.row];
-    std::string suffix = line.substr(at.col);
-    line = line.substr(0, at.col) + parts.front();
-
-    Position end;
-    if (parts.size() == 1) {
-        line += suffix;
-        end = {at.row, at.col + static_cast<int>(parts.front().size())};
-    } else {
-        std::vector<std::string> newLines;
-        for (size_t i = 1; i + 1 < parts.size(); ++i) newLines.push_back(parts[i]);
-        newLines.push_back(parts.back() + suffix);
-        lines_.insert(lines_.begin() + at.row + 1, newLines.begin(), newLines.end());
-        end = {at.row + static_cast<int>(parts.size()) - 1, static_cast<int>(parts.back().size())};
-    }
-
+    Position end = advance(at, text);
+    recordChange({at.row, 1, end.row - at.row + 1});
     cursor_ = end;
     desiredCol_ = end.col;
     modified_ = true;
@@ -127,20 +116,8 @@ std::string TextBuffer::eraseRange(Position from, Position to) {
     to = clampPosition(to);
     if (to < from) std::swap(from, to);
 
-    std::string erased;
-    if (from.row == to.row) {
-        erased = lines_[from.row].substr(from.col, to.col - from.col);
-        lines_[from.row].erase(from.col, to.col - from.col);
-    } else {
-        erased = lines_[from.row].substr(from.col);
-        for (int r = from.row + 1; r < to.row; ++r) {
-            erased += "\n" + lines_[r];
-        }
-        erased += "\n" + lines_[to.row].substr(0, to.col);
-
-        lines_[from.row] = lines_[from.row].substr(0, from.col) + lines_[to.row].substr(to.col);
-        lines_.erase(lines_.begin() + from.row + 1, lines_.begin() + to.row + 1);
-    }
+    std::string erased = storage_->erase(from, to);
+    recordChange({from.row, to.row - from.row + 1, 1});
 
     cursor_ = from;
     desiredCol_ = from.col;
@@ -152,14 +129,7 @@ std::string TextBuffer::textInRange(Position from, Position to) const {
     from = clampPosition(from);
     to = clampPosition(to);
     if (to < from) std::swap(from, to);
-
-    if (from.row == to.row) {
-        return lines_[from.row].substr(from.col, to.col - from.col);
-    }
-    std::string result = lines_[from.row].substr(from.col);
-    for (int r = from.row + 1; r < to.row; ++r) result += "\n" + lines_[r];
-    result += "\n" + lines_[to.row].substr(0, to.col);
-    return result;
+    return storage_->text(from, to);
 }
 
 namespace {
@@ -170,7 +140,7 @@ bool isWordChar(char c) {
 
 WordSpan TextBuffer::wordAt(Position p) const {
     p = clampPosition(p);
-    const std::string& line = lines_[p.row];
+    const std::string line = storage_->line(p.row);
     int s = p.col, e = p.col;
 
     // If the cursor sits right after a word (e.g. just after typing it, or
@@ -189,10 +159,72 @@ WordSpan TextBuffer::wordAt(Position p) const {
 
 void TextBuffer::loadLines(std::vector<std::string> lines) {
     if (lines.empty()) lines.push_back("");
-    lines_ = std::move(lines);
+    Row oldCount = lineCount();
+    storage_->load(std::move(lines));
+    loaded(oldCount);
+}
+
+void TextBuffer::loadText(TextBlock text) {
+    Row oldCount = lineCount();
+    storage_->loadText(std::move(text));
+    loaded(oldCount);
+}
+
+void TextBuffer::loadText(TextBlock text, StorageKind kind) {
+    Row oldCount = lineCount();
+    if (kind != kind_) {
+        storage_ = makeStorage(kind);
+        kind_ = kind;
+    }
+    storage_->loadText(std::move(text));
+    loaded(oldCount);
+}
+
+void TextBuffer::appendText(TextBlock text) {
+    Row oldCount = lineCount();
+    storage_->appendText(std::move(text));
+    // The last row may have grown, and any new rows follow it.
+    recordChange({oldCount - 1, 1, lineCount() - oldCount + 1});
+}
+
+void TextBuffer::loaded(Row oldLineCount) {
+    recordChange({0, oldLineCount, lineCount()});
     cursor_ = {0, 0};
     desiredCol_ = 0;
     modified_ = false;
 }
 
+namespace {
+// Past this many untaken changes, they are folded into one whole-document
+// change so a buffer nobody drains (tests, benchmarks) can't grow without
+// bound.
+constexpr size_t kMaxPendingChanges = 4096;
+} // namespace
+
+void TextBuffer::recordChange(LineChange change) {
+    if (changesCollapsed_) {
+        changes_.back().inserted = lineCount();
+    } else if (changes_.size() == kMaxPendingChanges) {
+        changes_.assign(1, {0, changesBaseLineCount_, lineCount()});
+        changesCollapsed_ = true;
+    } else {
+        changes_.push_back(change);
+    }
+}
+
+std::vector<LineChange> TextBuffer::takeChanges() {
+    changesBaseLineCount_ = lineCount();
+    changesCollapsed_ = false;
+    return std::exchange(changes_, {});
+}
+
+std::vector<std::string> TextBuffer::lines() const {
+    std::vector<std::string> out;
+    out.reserve(lineCount());
+    // One walk, not a lookup per row: that is slow when pieces hold many
+    // lines (StorageKind::LargeFile).
+    forEachLine(0, lineCount(), [&out](Row, std::string_view text) { out.emplace_back(text); });
+    return out;
+}
+
 } // namespace editor
@@ -1,19 +1,14 @@
 #pragma once
+#include <algorithm>
+#include <memory>
 #include <string>
 #include <vector>
 
-namespace editor {
-
-struct Position {
-    int row = 0;
-    int col = 0;
-};
+#include "core/LineRanges.h"
+#include "core/Position.h"
+#include "core/TextStorage.h"
 
-inline bool operator==(const Position& a, const Position& b) { return a.row == b.row && a.col == b.col; }
-inline bool operator!=(const Position& a, const Position& b) { return !(a == b); }
-inline bool operator<(const Position& a, const Position& b) {
-    return a.row != b.row ? a.row < b.row : a.col < b.col;
-}
+namespace editor {
 
 struct WordSpan {
     std::string text;
@@ -26,12 +21,13 @@ struct WordSpan {
 // shared by TextBuffer and UndoStack.
 Position advance(Position start, const std::string& text);
 
-// Line-oriented text storage: a vector of lines plus a (row, col) cursor.
+// Line-oriented view of the text plus a (row, col) cursor. The text itself
+// lives in a pluggable TextStorage (a piece table unless told otherwise).
 // Mutations go through insertText/eraseRange so that Document can record a
 // single undo entry per edit regardless of whether it spans lines.
 class TextBuffer {
 public:
-    TextBuffer();
+    explicit TextBuffer(StorageKind kind = StorageKind::PieceTable);
 
     void moveLeft();
     void moveRight();
@@ -59,17 +55,48 @@ public:
     Position clampPosition(Position p) const;
 
     void loadLines(std::vector<std::string> lines);
-    const std::vector<std::string>& lines() const { return lines_; }
+    void loadText(TextBlock text);
+    // The same into a fresh storage of `kind` - how a file big enough for
+    // StorageKind::LargeFile gets one.
+    void loadText(TextBlock text, StorageKind kind);
+    // More of the text being loaded, after the last byte. Not an edit: the
+    // cursor and the modified flag stay as they are.
+    void appendText(TextBlock text);
 
-    int lineCount() const { return static_cast<int>(lines_.size()); }
+    std::string line(Row row) const { return storage_->line(row); }
+    int lineLength(Row row) const { return storage_->lineLength(row); }
+    // Rows [first, last), clipped to the buffer, in one walk of the storage
+    // - the way to read a run of rows, such as the viewport.
+    void forEachLine(Row first, Row last, const LineVisitor& visit) const {
+        storage_->forEachLine(first, std::min(last, lineCount()), visit);
+    }
+    // Materializes every line - O(document). For tests and whole-buffer
+    // consumers only; per-row callers should use line()/lineLength().
+    std::vector<std::string> lines() const;
+    std::shared_ptr<const TextSnapshot> snapshot() const { return storage_->snapshot(); }
+
+    Row lineCount() const { return storage_->lineCount(); }
+    StorageKind storageKind() const { return kind_; }
     bool modified() const { return modified_; }
     void clearModified() { modified_ = false; }
 
+    // Every insert/erase/load since the last call, in order, as row-level
+    // changes - what incremental consumers (the spell checker) need to know
+    // which rows to revisit and how to shift what they already know.
+    std::vector<LineChange> takeChanges();
+
 private:
-    std::vector<std::string> lines_;
+    std::unique_ptr<TextStorage> storage_;
+    StorageKind kind_;
+    std::vector<LineChange> changes_;
+    Row changesBaseLineCount_ = 1; // line count when changes_ was last taken
+    bool changesCollapsed_ = false;
     Position cursor_;
     int desiredCol_ = 0;
     bool modified_ = false;
+
+    void recordChange(LineChange change);
+    void loaded(Row oldLineCount);
 };
 
 } // namespace editor
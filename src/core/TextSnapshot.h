@@ -0,0 +1,61 @@
+#pragma once
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "core/Position.h"
+
+namespace editor {
+
+// Called once per line, in row order. `text` is only valid for the duration
+// of the call.
+using LineVisitor = std::function<void(Row row, std::string_view text)>;
+// Called with consecutive runs of bytes, in order.
+using RunVisitor = std::function<void(std::string_view run)>;
+
+// An immutable view of the buffer's text at one point in time. Safe to read
+// from worker threads while the live TextBuffer keeps changing; paired with
+// a version number by the caller so late-arriving results can be detected
+// as stale.
+class TextSnapshot {
+public:
+    virtual ~TextSnapshot() = default;
+
+    virtual Row lineCount() const = 0;
+    virtual std::string line(Row row) const = 0;
+
+    // Visits rows [first, last). Sequential access is the cheap path: it
+    // walks the storage once rather than looking every row up separately.
+    virtual void forEachLine(Row first, Row last, const LineVisitor& visit) const = 0;
+    void forEachLine(const LineVisitor& visit) const { forEachLine(0, lineCount(), visit); }
+
+    // The whole text - the lines joined by '\n', without a final one - as
+    // byte runs, which is what saving writes. Joining the lines is the
+    // fallback; a storage that holds the bytes hands them out as they are.
+    virtual void forEachRun(const RunVisitor& visit) const {
+        forEachLine([&visit](Row row, std::string_view text) {
+            if (row > 0) visit("\n");
+            visit(text);
+        });
+    }
+};
+
+// Snapshot over a plain vector of lines - what LineVectorStorage hands out,
+// and a convenient way to build one from literal lines in tests.
+class LineVectorSnapshot : public TextSnapshot {
+public:
+    explicit LineVectorSnapshot(std::vector<std::string> lines) : lines_(std::move(lines)) {}
+    using TextSnapshot::forEachLine;
+
+    Row lineCount() const override { return static_cast<Row>(lines_.size()); }
+    std::string line(Row row) const override { return lines_[row]; }
+    void forEachLine(Row first, Row last, const LineVisitor& visit) const override {
+        for (Row r = first; r < last; ++r) visit(r, lines_[r]);
+    }
+
+private:
+    std::vector<std::string> lines_;
+};
+
+} // namespace editor
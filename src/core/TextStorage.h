@@ -0,0 +1,56 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/Position.h"
+#include "core/TextBlock.h"
+#include "core/TextSnapshot.h"
+
+namespace editor {
+
+// Backing store behind TextBuffer. TextBuffer owns the cursor, clamping and
+// the modified flag; a storage only has to hold the text and answer
+// line-oriented questions about it. Every Position handed to a storage has
+// already been clamped by TextBuffer, and ranges arrive ordered (from <= to).
+class TextStorage {
+public:
+    virtual ~TextStorage() = default;
+
+    virtual Row lineCount() const = 0;
+    virtual int lineLength(Row row) const = 0;
+    virtual std::string line(Row row) const = 0;
+    // Visits rows [first, last) in order. A storage whose row lookups walk
+    // its contents (the piece table) overrides this with one walk.
+    virtual void forEachLine(Row first, Row last, const LineVisitor& visit) const {
+        for (Row r = first; r < last; ++r) visit(r, line(r));
+    }
+
+    // Inserts `text` (may contain '\n') at `at`.
+    virtual void insert(Position at, const std::string& text) = 0;
+    // Removes [from, to) and returns the removed text.
+    virtual std::string erase(Position from, Position to) = 0;
+    virtual std::string text(Position from, Position to) const = 0;
+
+    // Replaces the whole contents. `lines` is never empty.
+    virtual void load(std::vector<std::string> lines) = 0;
+    // The same from one block of text. A storage that can keep pointing
+    // into the block (the piece table) does, rather than copying it.
+    virtual void loadText(TextBlock text) = 0;
+    // Appends `text` after the last byte, continuing the last line - the
+    // next part of a file that is still being loaded.
+    virtual void appendText(TextBlock text) = 0;
+
+    // Immutable copy of the current contents for worker threads.
+    virtual std::shared_ptr<const TextSnapshot> snapshot() const = 0;
+};
+
+enum class StorageKind {
+    PieceTable, // O(log pieces) edits regardless of file size - the default
+    LineVector, // the original vector<string>, kept as a benchmark baseline
+    LargeFile,  // a piece table with coarse pieces, for files too big to index finely
+};
+
+std::unique_ptr<TextStorage> makeStorage(StorageKind kind);
+
+} // namespace editor
@@ -1,60 +1,187 @@
 #include "io/FileIO.h"
 
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
 #include <fstream>
 #include <iterator>
+#include <memory>
+#include <string_view>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "io/MappedFile.h"
 
 namespace editor {
 
-LoadResult loadFile(const std::string& path) {
-    std::ifstream file(path, std::ios::binary);
-    if (!file.is_open()) {
-        return {false, {}, "Failed to open '" + path + "' for reading."};
+LoadResult openFile(const std::string& path) {
+    LoadResult result{true, {}, ""};
+    auto mapping = std::make_shared<MappedFile>(path, true); // watched; see LoadResult::mapping
+    if (mapping->valid()) {
+        result.text = {std::shared_ptr<const char>(mapping, mapping->data()), mapping->size()};
+        result.mapping = mapping;
+    } else {
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open()) {
+            return {false, {}, "Failed to open '" + path + "' for reading."};
+        }
+        auto content = std::make_shared<std::string>(std::istreambuf_iterator<char>(file),
+                                                     std::istreambuf_iterator<char>());
+        if (file.bad()) {
+            return {false, {}, "Error reading '" + path + "'."};
+        }
+        result.text = {std::shared_ptr<const char>(content, content->data()), content->size()};
     }
 
-    std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
-    if (file.bad()) {
-        return {false, {}, "Error reading '" + path + "'."};
+    // A final '\n' ends the last line rather than starting an empty one -
+    // getline-based splitting couldn't tell "ends with \n" from "doesn't",
+    // which used to make a save silently drop the file's trailing newline.
+    const char* bytes = result.text.data.get();
+    result.trailingNewline = result.text.size > 0 && bytes[result.text.size - 1] == '\n';
+    if (result.trailingNewline) result.text.size--;
+    return result;
+}
+
+LoadResult loadFile(const std::string& path) {
+    LoadResult result = openFile(path);
+    TextBlock& text = result.text;
+    text.newlines.resize((text.size + kTextBlockGranule - 1) / kTextBlockGranule);
+    countNewlinesPerGranule(text.data.get(), text.size, text.newlines.data());
+    return result;
+}
+
+namespace {
+// Runs shorter than this are copied into a staging buffer and go out many
+// at a time; longer ones are written from where they are, in the same
+// writev() as whatever is staged ahead of them.
+constexpr size_t kDirectRunBytes = size_t(64) << 10;
+constexpr size_t kStageBytes = size_t(1) << 20;
+
+// Writes all of `iov`, picking up after short writes and signals.
+bool writeAll(int fd, iovec* iov, int count) {
+    while (count > 0) {
+        ssize_t n = writev(fd, iov, count);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        size_t done = static_cast<size_t>(n);
+        for (; count > 0 && done >= iov->iov_len; ++iov, --count) done -= iov->iov_len;
+        if (count > 0) {
+            iov->iov_base = static_cast<char*>(iov->iov_base) + done;
+            iov->iov_len -= done;
+        }
     }
+    return true;
+}
 
-    LoadResult result;
-    result.success = true;
-    result.trailingNewline = !content.empty() && content.back() == '\n';
-
-    // Split on '\n' without emitting a spurious trailing empty line when the
-    // file ends with a newline (the usual case) - getline-based splitting
-    // can't distinguish "ends with \n" from "doesn't", which used to make a
-    // save silently drop the file's trailing newline.
-    size_t start = 0;
-    for (size_t i = 0; i < content.size(); ++i) {
-        if (content[i] == '\n') {
-            result.lines.push_back(content.substr(start, i - start));
-            start = i + 1;
+// Turns a stream of byte runs - lines and "\n"s, or a piece table's
+// pieces - into a few large writes.
+class BatchedWriter {
+public:
+    explicit BatchedWriter(int fd) : fd_(fd) { stage_.reserve(kStageBytes); }
+
+    void add(std::string_view run) {
+        bytes_ += run.size();
+        if (run.size() < kDirectRunBytes) {
+            if (stage_.size() + run.size() > kStageBytes) flush();
+            stage_.append(run);
+            return;
         }
+        // A run is only valid during the call that hands it out, so it
+        // can't wait for the next flush.
+        iovec iov[] = {{stage_.data(), stage_.size()}, {const_cast<char*>(run.data()), run.size()}};
+        ok_ = ok_ && writeAll(fd_, iov, 2);
+        stage_.clear();
     }
-    if (start < content.size()) {
-        result.lines.push_back(content.substr(start));
-    } else if (content.empty()) {
-        result.lines.push_back("");
+
+    bool finish() {
+        flush();
+        return ok_;
     }
+    size_t bytes() const { return bytes_; }
 
-    return result;
+private:
+    void flush() {
+        iovec iov{stage_.data(), stage_.size()};
+        ok_ = ok_ && writeAll(fd_, &iov, 1);
+        stage_.clear();
+    }
+
+    int fd_;
+    std::string stage_;
+    size_t bytes_ = 0;
+    bool ok_ = true;
+};
+
+// The file a save replaces: the target of a symlink rather than the link.
+std::string resolveTarget(const std::string& path) {
+    struct stat st;
+    if (lstat(path.c_str(), &st) != 0 || !S_ISLNK(st.st_mode)) return path;
+    std::unique_ptr<char, decltype(&std::free)> real(realpath(path.c_str(), nullptr), &std::free);
+    return real ? std::string(real.get()) : path;
 }
 
-SaveResult saveFile(const std::string& path, const std::vector<std::string>& lines, bool trailingNewline) {
-    std::ofstream file(path, std::ios::binary);
-    if (!file.is_open()) {
-        return {false, "Failed to open '" + path + "' for writing."};
-    }
+// Makes the rename itself durable; without this a crash can bring back the
+// old directory entry, or none.
+void syncDirectoryOf(const std::string& path) {
+    size_t slash = path.rfind('/');
+    std::string dir = slash == std::string::npos ? "." : slash == 0 ? "/" : path.substr(0, slash);
+    int fd = open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) return;
+    fsync(fd);
+    close(fd);
+}
 
-    for (size_t i = 0; i < lines.size(); ++i) {
-        file << lines[i];
-        if (i + 1 < lines.size() || trailingNewline) file << '\n';
+// Shared by both saveFile overloads: `forEachRun` feeds the text, in
+// order, to the visitor it is given. The text goes to a new file beside
+// the target, is fsync()ed, and only then renamed over the target, so a
+// crash at any point leaves either the old file or the new one - never a
+// torn mix. Each save gets its own temp file: an autosave and a save the
+// user asked for can be writing at the same time.
+template <typename ForEachRun>
+SaveResult writeRuns(const std::string& requested, bool trailingNewline, ForEachRun&& forEachRun) {
+    static std::atomic<unsigned> saves{0};
+    auto started = std::chrono::steady_clock::now();
+    std::string path = resolveTarget(requested);
+    std::string tmp = path + "." + std::to_string(getpid()) + "." + std::to_string(saves++) + ".tmp";
+    int fd = open(tmp.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0666);
+    if (fd < 0) {
+        return {false, "Failed to open '" + requested + "' for writing."};
     }
+    // The replacement keeps the permissions of the file it replaces.
+    struct stat st;
+    if (stat(path.c_str(), &st) == 0) fchmod(fd, st.st_mode & 07777);
 
-    if (file.fail()) {
-        return {false, "Error writing '" + path + "'."};
+    BatchedWriter out(fd);
+    forEachRun([&out](std::string_view run) { out.add(run); });
+    if (trailingNewline) out.add("\n");
+    bool written = out.finish() && fsync(fd) == 0;
+    written = close(fd) == 0 && written;
+    if (!written || std::rename(tmp.c_str(), path.c_str()) != 0) {
+        unlink(tmp.c_str());
+        return {false, "Error writing '" + requested + "'."};
     }
-    return {true, ""};
+    syncDirectoryOf(path);
+    return {true, "", out.bytes(), std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count()};
+}
+} // namespace
+
+SaveResult saveFile(const std::string& path, const std::vector<std::string>& lines, bool trailingNewline) {
+    return writeRuns(path, trailingNewline, [&](auto&& visit) {
+        for (size_t r = 0; r < lines.size(); ++r) {
+            if (r > 0) visit("\n");
+            visit(lines[r]);
+        }
+    });
+}
+
+SaveResult saveFile(const std::string& path, const TextSnapshot& lines, bool trailingNewline) {
+    return writeRuns(path, trailingNewline, [&](auto&& visit) { lines.forEachRun(visit); });
 }
 
 } // namespace editor
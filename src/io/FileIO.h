@@ -1,22 +1,58 @@
 #pragma once
+#include <cstddef>
+#include <memory>
 #include <string>
 #include <vector>
 
+#include "core/Newlines.h"
+#include "core/TextBlock.h"
+#include "core/TextSnapshot.h"
+#include "io/MappedFile.h"
+
 namespace editor {
 
 struct LoadResult {
     bool success;
-    std::vector<std::string> lines;
+    TextBlock text; // the file, less its final '\n'
     std::string error;
     bool trailingNewline = true; // whether the source file's last byte was '\n'
+    // What `text` points into, to ask whether it changed on disk; null if
+    // the file was read into memory instead.
+    std::shared_ptr<const MappedFile> mapping{};
+
+    // Copies the text out line by line - for tests and small consumers;
+    // the editor hands `text` to the document as is.
+    std::vector<std::string> lines() const { return splitLines(text.data.get(), text.size); }
 };
 
 struct SaveResult {
     bool success;
     std::string error;
+    size_t bytes = 0;
+    double seconds = 0; // including the fsync()s
+
+    double megabytesPerSecond() const { return seconds > 0 ? bytes / seconds / 1e6 : 0; }
 };
 
+// Maps the file read-only and returns the mapping itself as the text - no
+// read, no copy, no per-line allocation; pages fault in as they are first
+// touched. Files that can't be mapped (empty, or not regular files) are
+// read into memory instead. The text's newline index is left empty.
+LoadResult openFile(const std::string& path);
+// openFile() plus the newline index, counted on the calling thread.
+// loadFileParallel() (io/ParallelLoad.h) counts it on a pool instead.
 LoadResult loadFile(const std::string& path);
+// Writes to a temporary file beside `path`, fsync()s it, renames it over
+// `path` (keeping the old file's permissions; a symlink's target is what
+// gets replaced) and fsync()s the directory: a crash mid-save leaves the old
+// file intact. Never writing into the old file matters for another reason
+// too: a document loaded from it may still be reading from its mapping.
+// The text goes out in large writev() batches, not line by line. A
+// snapshot is written as the byte runs it hands out
+// (TextSnapshot::forEachRun): for a piece table, untouched stretches stream
+// straight from the mapping and only edits come from the add buffer, so no
+// line is ever assembled.
 SaveResult saveFile(const std::string& path, const std::vector<std::string>& lines, bool trailingNewline = true);
+SaveResult saveFile(const std::string& path, const TextSnapshot& lines, bool trailingNewline = true);
 
 } // namespace editor
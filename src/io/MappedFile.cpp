@@ -0,0 +1,65 @@
+#include "io/MappedFile.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+
+namespace editor {
+
+MappedFile::MappedFile(const std::string& path, bool watch) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        void* p = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED) {
+            data_ = static_cast<const char*>(p);
+            size_ = static_cast<size_t>(st.st_size);
+            if (watch) {
+                fd_ = fd;
+                mtime_ = st.st_mtim;
+                return;
+            }
+        }
+    }
+    // The mapping keeps the file alive; the descriptor isn't needed.
+    close(fd);
+}
+
+bool MappedFile::changedOnDisk() const {
+    struct stat st;
+    if (fd_ < 0 || fstat(fd_, &st) != 0) return false;
+    return static_cast<size_t>(st.st_size) != size_ || st.st_mtim.tv_sec != mtime_.tv_sec ||
+           st.st_mtim.tv_nsec != mtime_.tv_nsec;
+}
+
+MappedFile::~MappedFile() {
+    reset();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : data_(std::exchange(other.data_, nullptr)), size_(std::exchange(other.size_, 0)),
+      fd_(std::exchange(other.fd_, -1)), mtime_(other.mtime_) {}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        reset();
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+        fd_ = std::exchange(other.fd_, -1);
+        mtime_ = other.mtime_;
+    }
+    return *this;
+}
+
+void MappedFile::reset() {
+    if (data_) munmap(const_cast<char*>(data_), size_);
+    if (fd_ >= 0) close(fd_);
+    data_ = nullptr;
+    size_ = 0;
+    fd_ = -1;
+}
+
+} // namespace editor
@@ -0,0 +1,52 @@
+#pragma once
+#include <cstddef>
+#include <ctime>
+#include <string>
+
+namespace editor {
+
+// A whole file mapped read-only. Pages come straight from the page cache,
+// so nothing is copied or parsed up front and every process mapping the
+// same file shares one physical copy. An empty or unreadable file yields
+// an invalid mapping (valid() is false, data() is null).
+//
+// The mapping is private, so nothing is ever written through it, but it
+// still shows the file as it is on disk: another program rewriting the
+// file in place (`> file`, log rotation with copytruncate, an editor that
+// saves in place) changes the bytes under it, and touching a page past a
+// truncated end raises SIGBUS. Replacing the file by renaming over it - as
+// saveFile() does - is safe; the mapping keeps the old file. A mapping made
+// with `watch` can tell, through changedOnDisk(), when that has happened, so
+// the editor can reload or warn - but only when it asks: a change between
+// two checks can still be read, or fault.
+class MappedFile {
+public:
+    MappedFile() = default;
+    // `watch` keeps the file open and notes its size and modification time,
+    // for changedOnDisk(); otherwise the descriptor is closed once mapped.
+    explicit MappedFile(const std::string& path, bool watch = false);
+    ~MappedFile();
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool valid() const { return data_ != nullptr; }
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+    // Whether the mapped file's size or modification time has changed
+    // since it was mapped - that is, whether it was written in place.
+    // Always false for a mapping that isn't watched.
+    bool changedOnDisk() const;
+
+private:
+    void reset();
+
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    int fd_ = -1; // if watched: kept open to stat the mapped file, not whatever the path names now
+    timespec mtime_{};
+};
+
+} // namespace editor
@@ -0,0 +1,146 @@
+#include "io/ParallelLoad.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "core/Newlines.h"
+
+namespace editor {
+
+namespace {
+// Ranges per bulk worker, so a worker slowed down by page faults or by
+// other work doesn't hold up the whole load.
+constexpr size_t kRangesPerWorker = 4;
+
+size_t granules(size_t bytes) {
+    return (bytes + kTextBlockGranule - 1) / kTextBlockGranule;
+}
+
+// Range size for `bytes` of text: whole granules, and no smaller than
+// `minRangeBytes`.
+size_t rangeSize(const ThreadPool& pool, size_t bytes, size_t minRangeBytes) {
+    size_t perRange = bytes / (pool.bulkWorkerLimit() * kRangesPerWorker);
+    return granules(std::max({perRange, minRangeBytes, kTextBlockGranule})) * kTextBlockGranule;
+}
+
+// Counts [begin, end) of `text` into its newline index; `begin` is on a
+// granule boundary.
+void countInto(TextBlock& text, size_t begin, size_t end) {
+    countNewlinesPerGranule(text.data.get() + begin, end - begin, text.newlines.data() + begin / kTextBlockGranule);
+}
+
+// [begin, end) of `text` as a block of its own, sharing the bytes and
+// copying that part of the index.
+TextBlock slice(const TextBlock& text, size_t begin, size_t end) {
+    auto first = text.newlines.begin() + static_cast<std::ptrdiff_t>(begin / kTextBlockGranule);
+    return {std::shared_ptr<const char>(text.data, text.data.get() + begin), end - begin,
+            std::vector<uint16_t>(first, first + static_cast<std::ptrdiff_t>(granules(end - begin)))};
+}
+
+struct LoadJob {
+    LoadResult result;
+    LoadDone done;
+    size_t rangeBytes = 0;
+    std::atomic<size_t> remaining{0};
+};
+
+struct StreamJob {
+    TextBlock text; // the whole text; its index fills in range by range
+    LoadChunkDone more;
+    size_t start = 0; // where the ranges begin, just past the first chunk
+    size_t rangeBytes = 0;
+    std::mutex mutex;           // guards the two below
+    std::vector<bool> counted;  // per range
+    size_t delivered = 0;       // ranges handed to `more` so far
+
+    size_t rangeBegin(size_t r) const { return start + r * rangeBytes; }
+    size_t rangeEnd(size_t r) const { return std::min(rangeBegin(r + 1), text.size); }
+};
+
+// Marks range `r` counted and delivers whatever run of counted ranges now
+// follows the last delivered one. Delivering under the lock keeps the
+// chunks in order; the lock also publishes each range's counts to whoever
+// delivers them.
+void rangeCounted(StreamJob& job, size_t r) {
+    std::lock_guard<std::mutex> lock(job.mutex);
+    job.counted[r] = true;
+    size_t first = job.delivered;
+    while (job.delivered < job.counted.size() && job.counted[job.delivered]) ++job.delivered;
+    if (job.delivered == first) return;
+    size_t begin = job.rangeBegin(first), end = job.rangeEnd(job.delivered - 1);
+    job.more({slice(job.text, begin, end), end, job.text.size});
+}
+} // namespace
+
+void loadFileParallel(ThreadPool& pool, Lane lane, std::string path, LoadDone done, size_t minRangeBytes) {
+    pool.post(lane, [&pool, lane, path = std::move(path), done = std::move(done), minRangeBytes]() mutable {
+        auto job = std::make_shared<LoadJob>();
+        job->result = openFile(path);
+        job->done = std::move(done);
+        TextBlock& text = job->result.text;
+        if (!job->result.success) {
+            job->done(std::move(job->result));
+            return;
+        }
+
+        job->rangeBytes = rangeSize(pool, text.size, minRangeBytes);
+        text.newlines.resize(granules(text.size));
+        size_t ranges = (text.size + job->rangeBytes - 1) / job->rangeBytes;
+        if (ranges <= 1) {
+            countInto(text, 0, text.size);
+            job->done(std::move(job->result));
+            return;
+        }
+
+        // Ranges 1.. go to the pool; this task keeps range 0 for itself.
+        job->remaining = ranges;
+        auto finishRange = [job](size_t range) {
+            size_t begin = range * job->rangeBytes;
+            countInto(job->result.text, begin, std::min(begin + job->rangeBytes, job->result.text.size));
+            // acq_rel: the last finisher must see every other range's counts.
+            if (job->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) job->done(std::move(job->result));
+        };
+        for (size_t r = 1; r < ranges; ++r) pool.post(lane, [finishRange, r] { finishRange(r); });
+        finishRange(0);
+    });
+}
+
+void streamFileParallel(ThreadPool& pool, Lane lane, std::string path, LoadOpened opened, LoadChunkDone more,
+                        size_t firstBytes, size_t minRangeBytes) {
+    pool.post(lane, [&pool, lane, path = std::move(path), opened = std::move(opened), more = std::move(more),
+                     firstBytes, minRangeBytes]() mutable {
+        LoadResult result = openFile(path);
+        if (!result.success) {
+            opened(std::move(result), 0);
+            return;
+        }
+
+        auto job = std::make_shared<StreamJob>();
+        job->text = std::move(result.text);
+        job->more = std::move(more);
+        TextBlock& text = job->text;
+        text.newlines.resize(granules(text.size));
+        job->start = std::min(granules(std::max<size_t>(firstBytes, 1)) * kTextBlockGranule, text.size);
+        countInto(text, 0, job->start);
+
+        size_t rest = text.size - job->start;
+        job->rangeBytes = rangeSize(pool, rest, minRangeBytes);
+        size_t ranges = (rest + job->rangeBytes - 1) / job->rangeBytes;
+        job->counted.assign(ranges, false);
+
+        result.text = slice(text, 0, job->start);
+        opened(std::move(result), text.size);
+        for (size_t r = 0; r < ranges; ++r) {
+            pool.post(lane, [job, r] {
+                countInto(job->text, job->rangeBegin(r), job->rangeEnd(r));
+                rangeCounted(*job, r);
+            });
+        }
+    });
+}
+
+} // namespace editor
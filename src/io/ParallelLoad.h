@@ -0,0 +1,50 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <string>
+
+#include "concurrent/ThreadPool.h"
+#include "io/FileIO.h"
+
+namespace editor {
+
+using LoadDone = std::function<void(LoadResult)>;
+
+// The next part of a file being streamed in.
+struct LoadChunk {
+    TextBlock text;  // continues the text delivered before it, with its own newline index
+    size_t loaded;   // bytes delivered so far, this chunk included
+    size_t total;    // size of the whole text; the last chunk ends there
+};
+using LoadChunkDone = std::function<void(LoadChunk)>;
+
+// Below this, a file's newline index is counted by the task that opened
+// it; splitting it wouldn't pay for the extra tasks.
+constexpr size_t kMinLoadRangeBytes = size_t(4) << 20;
+// What a streaming load hands over first: a few thousand typical lines,
+// enough for the first screens, indexed in well under a millisecond.
+constexpr size_t kFirstChunkBytes = size_t(256) << 10;
+
+// loadFile() with the newline index counted in parallel: the file is
+// opened on `pool`, split into byte ranges of at least `minRangeBytes`
+// (rounded to whole kTextBlockGranule slices), and every range is counted
+// by its own task straight into its part of the index. Since the slices
+// never straddle a range, stitching the per-range tables together is just
+// where each task writes. Whichever range finishes last calls `done` on
+// its worker thread; `done` runs exactly once, also when the file can't be
+// opened. The result is the same as loadFile()'s.
+void loadFileParallel(ThreadPool& pool, Lane lane, std::string path, LoadDone done,
+                      size_t minRangeBytes = kMinLoadRangeBytes);
+
+// The same, streamed: `opened` gets the result as soon as the file is open
+// and its first `firstBytes` are indexed, with only those bytes as `text`
+// and the size of the whole text as the second argument. The rest is
+// counted across the pool as above, and handed to `more` in file order,
+// each chunk as soon as it and every range before it are counted. `more`
+// never runs concurrently with itself or before `opened` returns, and not
+// at all if the file couldn't be opened or fit in the first chunk.
+using LoadOpened = std::function<void(LoadResult first, size_t total)>;
+void streamFileParallel(ThreadPool& pool, Lane lane, std::string path, LoadOpened opened, LoadChunkDone more,
+                        size_t firstBytes = kFirstChunkBytes, size_t minRangeBytes = kMinLoadRangeBytes);
+
+} // namespace editor
@@ -0,0 +1,149 @@
+#include "spell/Completer.h"
+
+#include <algorithm>
+#include <cctype>
+#include <unordered_map>
+
+#include "spell/Dictionary.h"
+
+namespace editor {
+
+namespace {
+bool isWordChar(char c) {
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '\'';
+}
+
+// Shorter words aren't worth completing, or remembering for it.
+constexpr size_t kMinBufferWord = 3;
+// Rows visited between checks of the cancellation flag, as the scanner.
+constexpr int kRowsPerCancelCheck = 256;
+
+struct Candidate {
+    std::string_view word; // lowercase
+    uint32_t uses;         // in the document
+    uint32_t frequency;    // in the corpus
+};
+
+bool ranksBefore(const Candidate& a, const Candidate& b) {
+    if (a.uses != b.uses) return a.uses > b.uses;
+    if (a.frequency != b.frequency) return a.frequency > b.frequency;
+    if (a.word.size() != b.word.size()) return a.word.size() < b.word.size();
+    return a.word < b.word;
+}
+} // namespace
+
+BufferWords BufferWords::collect(const TextSnapshot& lines, const std::atomic<bool>& cancelled) {
+    std::unordered_map<std::string, uint32_t> counts;
+    std::string word;
+    auto collectLine = [&](Row, std::string_view line) {
+        size_t i = 0, n = line.size();
+        while (i < n) {
+            if (!isWordChar(line[i])) {
+                i++;
+                continue;
+            }
+            size_t start = i;
+            while (i < n && isWordChar(line[i])) i++;
+            if (i - start < kMinBufferWord) continue;
+            word.assign(line.substr(start, i - start));
+            for (char& c : word) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+            counts[word]++;
+        }
+    };
+    Row lineCount = lines.lineCount();
+    for (Row first = 0; first < lineCount; first += kRowsPerCancelCheck) {
+        if (cancelled) return {};
+        lines.forEachLine(first, std::min(lineCount, first + kRowsPerCancelCheck), collectLine);
+    }
+
+    BufferWords out;
+    out.entries_.reserve(counts.size());
+    for (auto& [w, n] : counts) out.entries_.emplace_back(w, n);
+    std::sort(out.entries_.begin(), out.entries_.end());
+    return out;
+}
+
+void Completer::build(const std::vector<std::string>& input, const WordFrequencies* frequencies) {
+    std::vector<std::string> words;
+    words.reserve(input.size());
+    for (const std::string& w : input) {
+        if (!w.empty()) words.push_back(Dictionary::normalize(w));
+    }
+    std::sort(words.begin(), words.end());
+    words.erase(std::unique(words.begin(), words.end()), words.end());
+
+    *this = Completer();
+    offsets_.reserve(words.size() + 1);
+    frequency_.reserve(words.size());
+    for (const std::string& w : words) {
+        offsets_.push_back(static_cast<uint32_t>(arena_.size()));
+        arena_.insert(arena_.end(), w.begin(), w.end());
+        frequency_.push_back(frequencies ? frequencies->count(w) : 0);
+    }
+    offsets_.push_back(static_cast<uint32_t>(arena_.size()));
+    arena_.shrink_to_fit();
+}
+
+std::vector<std::string> Completer::complete(std::string_view prefix, size_t limit, const BufferWords* buffer) const {
+    std::vector<std::string> out;
+    if (prefix.empty() || limit == 0) return out;
+    std::string key = Dictionary::normalize(prefix);
+    auto extends = [&key](std::string_view w) { return w.size() > key.size() && w.compare(0, key.size(), key) == 0; };
+
+    // Both sources are sorted, so the words extending `key` are a run in
+    // each, and walking the two runs in step meets a word both hold at once.
+    size_t count = size();
+    size_t d = 0;
+    for (size_t hi = count; d < hi;) {
+        size_t mid = d + (hi - d) / 2;
+        if (wordAt(mid) <= key) d = mid + 1;
+        else hi = mid;
+    }
+    static const std::vector<std::pair<std::string, uint32_t>> none;
+    const auto& entries = buffer ? buffer->entries() : none;
+    auto b = std::partition_point(entries.begin(), entries.end(), [&key](const auto& e) { return e.first <= key; });
+
+    // The best `limit` so far, the worst of them on top.
+    std::vector<Candidate> heap;
+    heap.reserve(limit);
+    auto offer = [&](const Candidate& c) {
+        if (heap.size() == limit) {
+            if (!ranksBefore(c, heap.front())) return;
+            std::pop_heap(heap.begin(), heap.end(), ranksBefore);
+            heap.pop_back();
+        }
+        heap.push_back(c);
+        std::push_heap(heap.begin(), heap.end(), ranksBefore);
+    };
+    for (;;) {
+        bool inDict = d < count && extends(wordAt(d));
+        bool inBuffer = b != entries.end() && extends(b->first);
+        if (!inDict && !inBuffer) break;
+        std::string_view dw = inDict ? wordAt(d) : std::string_view();
+        std::string_view bw = inBuffer ? std::string_view(b->first) : std::string_view();
+        if (inDict && (!inBuffer || dw < bw)) {
+            offer({dw, 0, frequency_[d++]});
+        } else if (inBuffer && (!inDict || bw < dw)) {
+            offer({bw, b->second, 0});
+            ++b;
+        } else {
+            offer({dw, b->second, frequency_[d++]});
+            ++b;
+        }
+    }
+
+    std::sort_heap(heap.begin(), heap.end(), ranksBefore);
+    out.reserve(heap.size());
+    for (const Candidate& c : heap) {
+        std::string word(prefix);
+        word.append(c.word.substr(key.size()));
+        out.push_back(std::move(word));
+    }
+    return out;
+}
+
+size_t Completer::bytesUsed() const {
+    return arena_.capacity() + offsets_.capacity() * sizeof(uint32_t) + frequency_.capacity() * sizeof(uint32_t);
+}
+
+} // namespace editor
@@ -0,0 +1,65 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "core/TextSnapshot.h"
+#include "spell/WordFrequencies.h"
+
+namespace editor {
+
+// The words of a document with how often each occurs, lowercased and
+// sorted so a prefix is a contiguous range. Collected on a worker from a
+// snapshot and immutable after that.
+class BufferWords {
+public:
+    // Every word of three letters or more in `lines`. Empty if `cancelled`
+    // is raised part way.
+    static BufferWords collect(const TextSnapshot& lines, const std::atomic<bool>& cancelled);
+
+    size_t size() const { return entries_.size(); }
+    const std::vector<std::pair<std::string, uint32_t>>& entries() const { return entries_; }
+
+private:
+    std::vector<std::pair<std::string, uint32_t>> entries_; // by word
+};
+
+// Word completion: the words starting with a prefix, best first. The
+// dictionary is kept sorted in one arena with each word's corpus frequency
+// beside it, so a prefix query is two binary searches and a scan of the
+// range it picks out; the document's own words (BufferWords) are merged
+// in as the same kind of range. Immutable once built, so any number of
+// threads may query it.
+class Completer {
+public:
+    // Replaces the contents. Words are lowercased and deduplicated;
+    // `frequencies` is read here, not kept.
+    void build(const std::vector<std::string>& words, const WordFrequencies* frequencies = nullptr);
+
+    // Up to `limit` words that extend `prefix` (case-insensitively), from
+    // the dictionary and `buffer`. Words the document already uses come
+    // first, by how often it uses them; then by corpus frequency, then
+    // shorter first, then alphabetically. Each is returned as `prefix`,
+    // exactly as typed, followed by the rest of the word, so accepting
+    // one only ever appends. `prefix` itself is never offered.
+    std::vector<std::string> complete(std::string_view prefix, size_t limit,
+                                      const BufferWords* buffer = nullptr) const;
+
+    size_t size() const { return offsets_.empty() ? 0 : offsets_.size() - 1; }
+    size_t bytesUsed() const;
+
+private:
+    std::string_view wordAt(size_t i) const {
+        return std::string_view(arena_.data() + offsets_[i], offsets_[i + 1] - offsets_[i]);
+    }
+
+    std::vector<char> arena_;        // sorted words, back to back
+    std::vector<uint32_t> offsets_;  // word i is [offsets_[i], offsets_[i + 1])
+    std::vector<uint32_t> frequency_; // per word
+};
+
+} // namespace editor
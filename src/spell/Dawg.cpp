@@ -0,0 +1,212 @@
+#include "spell/Dawg.h"
+
+#include <algorithm>
+#include <fstream>
+#include <unordered_map>
+#include <utility>
+
+#include "spell/Dictionary.h"
+
+namespace editor {
+
+namespace {
+inline char fold(char c) {
+    return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+// Targets are 22 bits wide.
+constexpr size_t kMaxEdges = size_t(1) << 22;
+
+// Trie node while building; minimized nodes are shared by index.
+struct BuildNode {
+    bool word = false;
+    std::vector<std::pair<char, uint32_t>> edges; // in label order
+};
+
+// Incremental construction from sorted input (Daciuk et al.): each new
+// word only changes the path after its common prefix with the previous
+// one, so everything below that point is final and can be minimized -
+// replaced by an identical, already-registered node - right away.
+class Builder {
+public:
+    Builder() : nodes_(1) {}
+
+    void add(std::string_view word) {
+        size_t common = 0;
+        while (common < word.size() && common < previous_.size() && word[common] == previous_[common]) ++common;
+        minimize(common);
+
+        uint32_t node = unchecked_.empty() ? 0 : unchecked_.back().child;
+        for (size_t i = common; i < word.size(); ++i) {
+            uint32_t child = static_cast<uint32_t>(nodes_.size());
+            nodes_.emplace_back();
+            nodes_[node].edges.emplace_back(word[i], child);
+            unchecked_.push_back({node, child});
+            node = child;
+        }
+        nodes_[node].word = true;
+        previous_.assign(word);
+    }
+
+    // Minimizes what's left; nodes_[0] is the root.
+    const std::vector<BuildNode>& finish() {
+        minimize(0);
+        return nodes_;
+    }
+
+private:
+    struct Pending {
+        uint32_t parent;
+        uint32_t child; // the parent's last edge points here
+    };
+
+    void minimize(size_t downTo) {
+        while (unchecked_.size() > downTo) {
+            Pending p = unchecked_.back();
+            unchecked_.pop_back();
+            auto [it, fresh] = register_.emplace(signature(nodes_[p.child]), p.child);
+            if (!fresh) nodes_[p.parent].edges.back().second = it->second;
+        }
+    }
+
+    // Two nodes are interchangeable if they agree on "is a word" and have
+    // the same edges to the same (already minimized) children.
+    static std::string signature(const BuildNode& n) {
+        std::string key(1, n.word ? '1' : '0');
+        for (auto [c, child] : n.edges) {
+            key.push_back(c);
+            key.append(reinterpret_cast<const char*>(&child), sizeof child);
+        }
+        return key;
+    }
+
+    std::vector<BuildNode> nodes_;
+    std::vector<Pending> unchecked_;
+    std::unordered_map<std::string, uint32_t> register_;
+    std::string previous_;
+};
+} // namespace
+
+void Dawg::build(std::vector<std::string> words) {
+    for (std::string& w : words) w = Dictionary::normalize(w);
+    std::sort(words.begin(), words.end());
+    words.erase(std::unique(words.begin(), words.end()), words.end());
+
+    Builder builder;
+    size_t count = 0;
+    for (const std::string& w : words) {
+        if (w.empty()) continue;
+        builder.add(w);
+        ++count;
+    }
+    const std::vector<BuildNode>& nodes = builder.finish();
+
+    // Lay the minimized graph out breadth-first: a node's run of edges is
+    // placed when the node is first reached, and filled in when dequeued.
+    std::vector<uint32_t> placed(nodes.size(), 0);
+    std::vector<uint32_t> queue;
+    std::vector<uint32_t> edges{0};
+    auto place = [&](uint32_t node) {
+        if (nodes[node].edges.empty() || placed[node] != 0) return;
+        placed[node] = static_cast<uint32_t>(edges.size());
+        edges.resize(edges.size() + nodes[node].edges.size());
+        queue.push_back(node);
+    };
+    place(0);
+    for (size_t q = 0; q < queue.size(); ++q) {
+        const BuildNode& n = nodes[queue[q]];
+        for (size_t i = 0; i < n.edges.size(); ++i) {
+            auto [c, child] = n.edges[i];
+            place(child);
+            edges[placed[queue[q]] + i] = static_cast<uint32_t>(static_cast<unsigned char>(c)) |
+                                          (nodes[child].word ? 1u << 8 : 0) |
+                                          (i + 1 == n.edges.size() ? 1u << 9 : 0) | (placed[child] << 10);
+        }
+        if (edges.size() >= kMaxEdges) break; // can't be encoded; leave the graph empty
+    }
+
+    *this = Dawg();
+    if (edges.size() >= kMaxEdges) return;
+    edges.shrink_to_fit();
+    edges_ = std::move(edges);
+    root_ = placed[0];
+    count_ = count;
+    if (root_ != 0) {
+        for (uint32_t i = root_;; ++i) {
+            rootEdge_[static_cast<unsigned char>(label(edges_[i]))] = edges_[i];
+            if (isLast(edges_[i])) break;
+        }
+    }
+}
+
+void Dawg::loadFromFile(const std::string& path) {
+    std::ifstream file(path);
+    std::vector<std::string> words;
+    std::string word;
+    while (file >> word) words.push_back(std::move(word));
+    build(std::move(words));
+}
+
+bool Dawg::step(State& s, char c) const {
+    if (s.edges == 0) return false;
+    unsigned char want = static_cast<unsigned char>(fold(c));
+    if (s.edges == root_) {
+        uint32_t e = rootEdge_[want];
+        if (e == 0) return false;
+        s = {target(e), isWord(e)};
+        return true;
+    }
+    for (uint32_t i = s.edges;; ++i) {
+        uint32_t e = edges_[i];
+        unsigned char have = static_cast<unsigned char>(label(e));
+        if (have == want) {
+            s = {target(e), isWord(e)};
+            return true;
+        }
+        // Labels are sorted, so passing `want` means it isn't here.
+        if (have > want || isLast(e)) return false;
+    }
+}
+
+bool Dawg::contains(std::string_view word) const {
+    State s = start();
+    for (char c : word) {
+        if (!step(s, c)) return false;
+    }
+    return s.word;
+}
+
+bool Dawg::hasPrefix(std::string_view prefix) const {
+    if (count_ == 0) return false;
+    State s = start();
+    for (char c : prefix) {
+        if (!step(s, c)) return false;
+    }
+    return true;
+}
+
+std::vector<std::string> Dawg::wordsWithPrefix(std::string_view prefix, size_t limit) const {
+    std::vector<std::string> out;
+    State s = start();
+    for (char c : prefix) {
+        if (!step(s, c)) return out;
+    }
+    std::string word = Dictionary::normalize(prefix);
+    if (s.word && !word.empty() && limit > 0) out.push_back(word);
+
+    // Depth-first in label order yields words in lexicographic order.
+    auto walk = [&](auto& self, State from) -> void {
+        forEachEdge(from, [&](char c, State next) {
+            if (out.size() >= limit) return;
+            word.push_back(c);
+            if (next.word) out.push_back(word);
+            self(self, next);
+            word.pop_back();
+        });
+    };
+    walk(walk, s);
+    if (out.size() > limit) out.resize(limit);
+    return out;
+}
+
+} // namespace editor
@@ -0,0 +1,79 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace editor {
+
+// The word list as a minimized DAWG (directed acyclic word graph): a trie
+// whose identical subtrees - shared suffixes like "-ing", "-ness", "-s" -
+// are stored once. Unlike Dictionary's hash table it can answer prefix
+// questions, which is what lets suggest() prune whole families of edit
+// candidates as soon as their prefix leaves the dictionary, and a fraction
+// of the size.
+//
+// Stored as one flat array of 4-byte edges: a node is the run of edges
+// leaving it, sorted by label, and each edge records its label, whether the
+// path up to and including it spells a word, whether it is the node's last
+// edge, and where the target node's run starts. Words are lowercased when
+// built; lookups fold case as they walk. Immutable once built, so any
+// number of threads may read it.
+class Dawg {
+public:
+    // Replaces the contents. Words are lowercased, sorted and deduplicated.
+    void build(std::vector<std::string> words);
+    // Whitespace-separated word list, as Dictionary::loadFromFile().
+    void loadFromFile(const std::string& path);
+
+    bool contains(std::string_view word) const;
+    bool hasPrefix(std::string_view prefix) const;
+    // Words starting with `prefix`, in lexicographic order, at most `limit`.
+    std::vector<std::string> wordsWithPrefix(std::string_view prefix, size_t limit = SIZE_MAX) const;
+
+    size_t size() const { return count_; }
+    size_t edgeCount() const { return edges_.size() - 1; }
+    size_t bytesUsed() const { return edges_.capacity() * sizeof(uint32_t) + sizeof rootEdge_; }
+
+    // Walking the graph one letter at a time, for searches that build
+    // words as they go (see suggest()).
+    struct State {
+        uint32_t edges = 0; // first edge of the node; 0 = no outgoing edges
+        bool word = false;  // the path so far is a whole word
+    };
+    State start() const { return {root_, false}; }
+    // Follows the edge for `c` (case-folded). False, leaving `s` as it was,
+    // if there is none.
+    bool step(State& s, char c) const;
+    // Calls visit(char label, State next) for each edge out of `s`, in
+    // label order.
+    template <typename F>
+    void forEachEdge(State s, F&& visit) const {
+        if (s.edges == 0) return;
+        for (uint32_t i = s.edges;; ++i) {
+            uint32_t e = edges_[i];
+            visit(label(e), State{target(e), isWord(e)});
+            if (isLast(e)) break;
+        }
+    }
+
+private:
+    // Edge layout: bits 0-7 label, bit 8 "spells a word", bit 9 "last edge
+    // of its node", bits 10-31 index of the target node's first edge.
+    static char label(uint32_t e) { return static_cast<char>(e & 0xff); }
+    static bool isWord(uint32_t e) { return (e >> 8) & 1; }
+    static bool isLast(uint32_t e) { return (e >> 9) & 1; }
+    static uint32_t target(uint32_t e) { return e >> 10; }
+
+    std::vector<uint32_t> edges_{0}; // edges_[0] is unused, so 0 can mean "none"
+    uint32_t root_ = 0;
+    // The root's edges by (folded) first letter, 0 if absent. The root has
+    // the widest fan-out, so every walk starts with a direct index instead
+    // of its longest scan.
+    std::array<uint32_t, 256> rootEdge_{};
+    size_t count_ = 0;
+};
+
+} // namespace editor
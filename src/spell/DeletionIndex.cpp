@@ -0,0 +1,191 @@
+#include "spell/DeletionIndex.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <tuple>
+
+#include "spell/Dictionary.h"
+
+namespace editor {
+
+namespace {
+// FNV-1a with a murmur3 finalizer, as Dictionary's table uses: the top 16
+// bits pick the bucket, so they have to be well mixed.
+uint32_t hashKey(std::string_view key) {
+    uint64_t h = 1469598103934665603ull;
+    for (char c : key) {
+        h ^= static_cast<unsigned char>(c);
+        h *= 1099511628211ull;
+    }
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    return static_cast<uint32_t>(h);
+}
+
+// Calls visit(std::string_view) for `word` and every string made by
+// deleting up to `maxDeletes` (0-2) of its letters, reusing one buffer.
+// The same string can come up more than once ("aab" minus either 'a').
+template <typename F>
+void forEachDeletion(std::string_view word, int maxDeletes, std::string& buf, F&& visit) {
+    visit(word);
+    size_t n = word.size();
+    for (size_t i = 0; i < n && maxDeletes >= 1; ++i) {
+        buf.assign(word.substr(0, i));
+        buf.append(word.substr(i + 1));
+        visit(std::string_view(buf));
+        if (maxDeletes < 2) continue;
+        for (size_t j = i + 1; j < n; ++j) {
+            buf.assign(word.substr(0, i));
+            buf.append(word.substr(i + 1, j - i - 1));
+            buf.append(word.substr(j + 1));
+            visit(std::string_view(buf));
+        }
+    }
+}
+
+// Optimal-string-alignment distance (Damerau-Levenshtein where a swapped
+// pair can't be edited again), or bound + 1 once it must exceed `bound`.
+int boundedDistance(std::string_view a, std::string_view b, int bound, std::vector<int>& rows) {
+    int la = static_cast<int>(a.size()), lb = static_cast<int>(b.size());
+    if (std::abs(la - lb) > bound) return bound + 1;
+    rows.assign(3 * (lb + 1), 0);
+    int* twoBack = rows.data();
+    int* prev = twoBack + lb + 1;
+    int* cur = prev + lb + 1;
+    for (int j = 0; j <= lb; ++j) prev[j] = j;
+    for (int i = 1; i <= la; ++i) {
+        cur[0] = i;
+        int rowMin = i;
+        for (int j = 1; j <= lb; ++j) {
+            int cost = a[i - 1] == b[j - 1] ? 0 : 1;
+            int d = std::min({prev[j] + 1, cur[j - 1] + 1, prev[j - 1] + cost});
+            if (i > 1 && j > 1 && a[i - 1] == b[j - 2] && a[i - 2] == b[j - 1]) d = std::min(d, twoBack[j - 2] + 1);
+            cur[j] = d;
+            rowMin = std::min(rowMin, d);
+        }
+        if (rowMin > bound) return bound + 1;
+        std::swap(twoBack, prev);
+        std::swap(prev, cur);
+    }
+    return std::min(prev[lb], bound + 1);
+}
+} // namespace
+
+template <typename F>
+void DeletionIndex::forEachFiled(uint32_t hash, F&& visit) const {
+    uint16_t low = static_cast<uint16_t>(hash);
+    auto first = keys_.begin() + bucket_[hash >> 16];
+    auto last = keys_.begin() + bucket_[(hash >> 16) + 1];
+    auto it = std::lower_bound(first, last, low);
+    if (it == last || *it != low) return;
+    uint32_t v = values_[it - keys_.begin()];
+    if (v & kTag) {
+        visit(v & ~kTag);
+        return;
+    }
+    for (;; ++v) {
+        visit(postings_[v] & ~kTag);
+        if (postings_[v] & kTag) return;
+    }
+}
+
+void DeletionIndex::build(const std::vector<std::string>& input) {
+    std::vector<std::string> words;
+    words.reserve(input.size());
+    for (const std::string& w : input) {
+        if (!w.empty()) words.push_back(Dictionary::normalize(w));
+    }
+    std::sort(words.begin(), words.end());
+    words.erase(std::unique(words.begin(), words.end()), words.end());
+
+    *this = DeletionIndex();
+    offsets_.reserve(words.size() + 1);
+    for (const std::string& w : words) {
+        offsets_.push_back(static_cast<uint32_t>(arena_.size()));
+        arena_.insert(arena_.end(), w.begin(), w.end());
+        arena_.push_back('\0');
+    }
+    offsets_.push_back(static_cast<uint32_t>(arena_.size()));
+
+    // (hash, word id) for every deletion of every word, grouped by hash.
+    std::vector<uint64_t> filed;
+    std::string buf;
+    for (uint32_t id = 0; id < words.size(); ++id) {
+        forEachDeletion(words[id], kMaxDistance, buf, [&](std::string_view key) {
+            filed.push_back(static_cast<uint64_t>(hashKey(key)) << 32 | id);
+        });
+    }
+    std::sort(filed.begin(), filed.end());
+    filed.erase(std::unique(filed.begin(), filed.end()), filed.end());
+
+    bucket_.assign((1u << 16) + 1, 0);
+    for (size_t i = 0; i < filed.size();) {
+        uint32_t hash = static_cast<uint32_t>(filed[i] >> 32);
+        size_t end = i + 1;
+        while (end < filed.size() && static_cast<uint32_t>(filed[end] >> 32) == hash) ++end;
+
+        bucket_[(hash >> 16) + 1]++;
+        keys_.push_back(static_cast<uint16_t>(hash));
+        if (end - i == 1) {
+            values_.push_back(kTag | static_cast<uint32_t>(filed[i]));
+        } else {
+            values_.push_back(static_cast<uint32_t>(postings_.size()));
+            for (size_t k = i; k < end; ++k) postings_.push_back(static_cast<uint32_t>(filed[k]));
+            postings_.back() |= kTag;
+        }
+        i = end;
+    }
+    for (size_t b = 1; b < bucket_.size(); ++b) bucket_[b] += bucket_[b - 1];
+    keys_.shrink_to_fit();
+    values_.shrink_to_fit();
+    postings_.shrink_to_fit();
+}
+
+std::vector<DeletionIndex::Match> DeletionIndex::matches(std::string_view word, int maxDistance,
+                                                         const std::atomic<bool>& cancelled) const {
+    std::vector<Match> out;
+    if (size() == 0 || word.empty()) return out;
+    maxDistance = std::clamp(maxDistance, 0, kMaxDistance);
+    std::string query = Dictionary::normalize(word);
+
+    // Every word sharing a deletion with the query, each verified once.
+    // The lookups are independent and each is a few cache misses into
+    // megabytes of index, so they go in passes - directory, then keys -
+    // with prefetches that let the misses of all of them overlap.
+    std::vector<uint32_t> hashes;
+    std::string buf;
+    forEachDeletion(query, maxDistance, buf, [&hashes](std::string_view key) { hashes.push_back(hashKey(key)); });
+    for (uint32_t h : hashes) __builtin_prefetch(&bucket_[h >> 16]);
+    for (uint32_t h : hashes) __builtin_prefetch(keys_.data() + bucket_[h >> 16]);
+    std::vector<uint32_t> candidates;
+    for (uint32_t h : hashes) forEachFiled(h, [&candidates](uint32_t id) { candidates.push_back(id); });
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+    std::vector<int> rows;
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        if (i % 64 == 0 && cancelled) break;
+        std::string_view w = wordAt(candidates[i]);
+        int d = boundedDistance(query, w, maxDistance, rows);
+        if (d <= maxDistance) out.push_back({w, d});
+    }
+    return out;
+}
+
+std::vector<DeletionIndex::Match> DeletionIndex::lookup(std::string_view word, int maxDistance,
+                                                        const std::atomic<bool>& cancelled) const {
+    std::vector<Match> out = matches(word, maxDistance, cancelled);
+    std::sort(out.begin(), out.end(), [](const Match& a, const Match& b) {
+        return std::tie(a.distance, a.word) < std::tie(b.distance, b.word);
+    });
+    return out;
+}
+
+size_t DeletionIndex::bytesUsed() const {
+    return arena_.capacity() + offsets_.capacity() * sizeof(uint32_t) + bucket_.capacity() * sizeof(uint32_t) +
+           keys_.capacity() * sizeof(uint16_t) + values_.capacity() * sizeof(uint32_t) +
+           postings_.capacity() * sizeof(uint32_t);
+}
+
+} // namespace editor
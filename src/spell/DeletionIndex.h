@@ -0,0 +1,65 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace editor {
+
+// SymSpell-style deletion index: every word is filed under each string
+// reachable from it by deleting up to kMaxDistance letters ("world" under
+// "world", "orld", "wrld", ..., "rld", "wld", ...). Two words within
+// Damerau-Levenshtein distance 2 of each other always share such a
+// deletion, so a lookup only has to generate the query's own deletions
+// (1 + n + n(n-1)/2 of them), look each one up, and verify the few words
+// filed there - no dictionary-wide scan and no per-candidate probing.
+//
+// Deletions are not stored, only their 32-bit hashes: the top 16 bits pick
+// a bucket from a directory, the low 16 are kept sorted within it. A hash
+// collision merely adds a candidate that verification then rejects.
+// Immutable once built, so any number of threads may read it.
+class DeletionIndex {
+public:
+    static constexpr int kMaxDistance = 2;
+
+    struct Match {
+        std::string_view word; // lowercase, owned by the index
+        int distance;
+    };
+
+    // Replaces the contents. Words are lowercased and deduplicated.
+    void build(const std::vector<std::string>& words);
+
+    // Every indexed word within `maxDistance` (at most kMaxDistance) of
+    // `word`, case-insensitively, in no particular order. Returns what it
+    // has so far if `cancelled` is raised.
+    std::vector<Match> matches(std::string_view word, int maxDistance, const std::atomic<bool>& cancelled) const;
+    // The same, nearest first and alphabetical within a distance.
+    std::vector<Match> lookup(std::string_view word, int maxDistance, const std::atomic<bool>& cancelled) const;
+
+    size_t size() const { return offsets_.empty() ? 0 : offsets_.size() - 1; }
+    size_t bytesUsed() const;
+
+private:
+    std::string_view wordAt(uint32_t id) const {
+        return std::string_view(arena_.data() + offsets_[id], offsets_[id + 1] - offsets_[id] - 1);
+    }
+    // Calls visit(uint32_t wordId) for every word filed under `hash`.
+    template <typename F>
+    void forEachFiled(uint32_t hash, F&& visit) const;
+
+    // Word ids have the top bit free; in values_ it marks a lone word
+    // stored inline, in postings_ the last word of a group.
+    static constexpr uint32_t kTag = 0x80000000u;
+
+    std::vector<char> arena_;       // words, NUL-terminated
+    std::vector<uint32_t> offsets_; // word id -> arena offset; one extra at the end
+    std::vector<uint32_t> bucket_;  // hash >> 16 -> first key; one extra at the end
+    std::vector<uint16_t> keys_;    // low 16 bits of each hash, sorted per bucket
+    std::vector<uint32_t> values_;  // per key: kTag | word id, or a postings_ index
+    std::vector<uint32_t> postings_;
+};
+
+} // namespace editor
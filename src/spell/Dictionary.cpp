@@ -1,29 +1,246 @@
 #include "spell/Dictionary.h"
 
 #include <algorithm>
-#include <cctype>
+#include <cstdio>
+#include <cstring>
 #include <fstream>
+#include <sys/stat.h>
+#include <utility>
 
 namespace editor {
 
-std::string Dictionary::normalize(const std::string& word) {
-    std::string out = word;
-    std::transform(out.begin(), out.end(), out.begin(), [](unsigned char c) { return std::tolower(c); });
+namespace {
+// Grow when the table would pass 70% full; with stored hashes, probes past
+// the home slot are cheap, so a fairly dense table is fine.
+constexpr size_t kMaxLoadNum = 7;
+constexpr size_t kMaxLoadDen = 10;
+
+// ASCII case folding, same as std::tolower in the "C" locale but inlinable.
+inline char fold(char c) {
+    return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+// FNV-1a over the case-folded bytes with a murmur3 finalizer, so the low
+// bits used for the slot index are well mixed. Folding here (and in the
+// compare in probe()) is what lets lookups skip building a lowercased copy.
+uint32_t hashWord(std::string_view word) {
+    uint64_t h = 1469598103934665603ull;
+    for (char c : word) {
+        h ^= static_cast<unsigned char>(fold(c));
+        h *= 1099511628211ull;
+    }
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    return static_cast<uint32_t>(h);
+}
+// Stored words are lowercase and NUL-terminated. Stops at the stored NUL,
+// so a longer `word` never reads past it; the NUL doubles as the length check.
+bool matches(const char* stored, std::string_view word) {
+    for (char c : word) {
+        if (*stored == '\0' || *stored != fold(c)) return false;
+        ++stored;
+    }
+    return *stored == '\0';
+}
+
+// dictionary.bin: this header, then Slot[slotCount], then the arena -
+// exactly the in-memory layout, so loading is mmap plus these checks.
+// Native byte order; a file from a machine of the other endianness fails
+// the version check. Bump kFormatVersion whenever hashWord() or the
+// layout changes, or old files would map but miss every lookup.
+constexpr char kMagic[8] = {'T', 'E', 'D', 'I', 'C', 'T', '\r', '\n'};
+constexpr uint32_t kFormatVersion = 1;
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t slotCount;
+    uint64_t wordCount;
+    uint64_t arenaBytes;
+    uint64_t sourceSize;
+    int64_t sourceMtimeNs;
+};
+static_assert(sizeof(FileHeader) == 48, "FileHeader is written as-is");
+} // namespace
+
+std::string Dictionary::normalize(std::string_view word) {
+    std::string out(word);
+    std::transform(out.begin(), out.end(), out.begin(), fold);
     return out;
 }
 
+Dictionary& Dictionary::operator=(Dictionary&& other) noexcept {
+    if (this != &other) {
+        // Vector and mapping moves keep their buffers where they are, so
+        // the view pointers carry over unchanged.
+        arena_ = std::move(other.arena_);
+        slots_ = std::move(other.slots_);
+        mapping_ = std::move(other.mapping_);
+        words_ = std::exchange(other.words_, nullptr);
+        wordBytes_ = std::exchange(other.wordBytes_, 0);
+        table_ = std::exchange(other.table_, nullptr);
+        slotCount_ = std::exchange(other.slotCount_, 0);
+        count_ = std::exchange(other.count_, 0);
+        other.clear();
+    }
+    return *this;
+}
+
+void Dictionary::clear() {
+    arena_ = {};
+    slots_ = {};
+    mapping_ = MappedFile();
+    words_ = nullptr;
+    wordBytes_ = 0;
+    table_ = nullptr;
+    slotCount_ = 0;
+    count_ = 0;
+}
+
+std::optional<Dictionary::SourceStamp> Dictionary::stampOf(const std::string& path) {
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) return std::nullopt;
+#ifdef __APPLE__
+    const struct timespec& mtime = st.st_mtimespec;
+#else
+    const struct timespec& mtime = st.st_mtim;
+#endif
+    return SourceStamp{static_cast<uint64_t>(st.st_size), static_cast<int64_t>(mtime.tv_sec) * 1000000000 + mtime.tv_nsec};
+}
+
 void Dictionary::loadFromFile(const std::string& path) {
+    clear();
     std::ifstream file(path);
     if (!file.is_open()) return;
 
     std::string word;
     while (file >> word) {
-        words_.insert(normalize(word));
+        insert(normalize(word));
+    }
+    arena_.shrink_to_fit();
+    words_ = arena_.data();
+}
+
+bool Dictionary::loadBinary(const std::string& path, const std::optional<SourceStamp>& source) {
+    MappedFile file(path);
+    if (!file.valid() || file.size() < sizeof(FileHeader)) return false;
+    FileHeader h;
+    std::memcpy(&h, file.data(), sizeof h);
+    if (std::memcmp(h.magic, kMagic, sizeof kMagic) != 0 || h.version != kFormatVersion) return false;
+    if (source && !(*source == SourceStamp{h.sourceSize, h.sourceMtimeNs})) return false;
+
+    // Sizes must add up to the file exactly, and the table must be one
+    // probe() can walk: a power of two with at least one free slot.
+    uint64_t slotCount = h.slotCount;
+    if (slotCount == 0 || (slotCount & (slotCount - 1)) != 0 || h.wordCount >= slotCount) return false;
+    if (h.arenaBytes == 0 || h.arenaBytes >= kEmpty) return false;
+    if (file.size() != sizeof h + slotCount * sizeof(Slot) + h.arenaBytes) return false;
+    const Slot* table = reinterpret_cast<const Slot*>(file.data() + sizeof h);
+    const char* words = file.data() + sizeof h + slotCount * sizeof(Slot);
+    // Every word, including the last, must end inside the arena.
+    if (words[h.arenaBytes - 1] != '\0') return false;
+    // One pass over the table (a few hundred KiB) so a bad offset can't
+    // send a lookup outside the mapping later.
+    uint64_t used = 0;
+    for (uint64_t i = 0; i < slotCount; ++i) {
+        if (table[i].offset == kEmpty) continue;
+        if (table[i].offset >= h.arenaBytes) return false;
+        ++used;
+    }
+    if (used != h.wordCount) return false;
+
+    clear();
+    mapping_ = std::move(file);
+    words_ = words;
+    wordBytes_ = h.arenaBytes;
+    table_ = table;
+    slotCount_ = slotCount;
+    count_ = h.wordCount;
+    return true;
+}
+
+bool Dictionary::writeBinary(const std::string& path, const SourceStamp& source) const {
+    if (count_ == 0) return false;
+    FileHeader h{};
+    std::memcpy(h.magic, kMagic, sizeof kMagic);
+    h.version = kFormatVersion;
+    h.slotCount = static_cast<uint32_t>(slotCount_);
+    h.wordCount = count_;
+    h.arenaBytes = wordBytes_;
+    h.sourceSize = source.size;
+    h.sourceMtimeNs = source.mtimeNs;
+
+    // Write beside the target and rename over it: an editor that has the
+    // old file mapped keeps reading the old pages rather than a torn mix.
+    std::string tmp = path + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(&h), sizeof h);
+        out.write(reinterpret_cast<const char*>(table_), static_cast<std::streamsize>(slotCount_ * sizeof(Slot)));
+        out.write(words_, static_cast<std::streamsize>(wordBytes_));
+        out.close();
+        if (out.fail()) {
+            std::remove(tmp.c_str());
+            return false;
+        }
+    }
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+void Dictionary::load(const std::string& textPath, const std::vector<std::string>& binaryPaths) {
+    std::optional<SourceStamp> source = stampOf(textPath);
+    for (const std::string& bin : binaryPaths) {
+        if (loadBinary(bin, source)) return;
+    }
+    loadFromFile(textPath);
+}
+
+size_t Dictionary::probe(std::string_view word, uint32_t hash) const {
+    size_t mask = slotCount_ - 1;
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+        const Slot& s = table_[i];
+        if (s.offset == kEmpty) return i;
+        if (s.hash == hash && matches(words_ + s.offset, word)) return i;
+    }
+}
+
+void Dictionary::insert(std::string_view word) {
+    if (word.empty()) return;
+    if ((count_ + 1) * kMaxLoadDen > slots_.size() * kMaxLoadNum) rehash(std::max<size_t>(slots_.size() * 2, 1024));
+    uint32_t hash = hashWord(word);
+    words_ = arena_.data(); // the arena may have grown since the last insert
+    size_t i = probe(word, hash);
+    if (slots_[i].offset != kEmpty) return; // duplicate (e.g. "Polish" and "polish")
+
+    slots_[i] = {static_cast<uint32_t>(arena_.size()), hash};
+    arena_.insert(arena_.end(), word.begin(), word.end());
+    arena_.push_back('\0');
+    wordBytes_ = arena_.size();
+    count_++;
+}
+
+void Dictionary::rehash(size_t slotCount) {
+    std::vector<Slot> old = std::move(slots_);
+    slots_.assign(slotCount, Slot{kEmpty, 0});
+    size_t mask = slotCount - 1;
+    for (const Slot& s : old) {
+        if (s.offset == kEmpty) continue;
+        size_t i = s.hash & mask;
+        while (slots_[i].offset != kEmpty) i = (i + 1) & mask;
+        slots_[i] = s;
     }
+    table_ = slots_.data();
+    slotCount_ = slotCount;
 }
 
-bool Dictionary::contains(const std::string& word) const {
-    return words_.count(normalize(word)) > 0;
+bool Dictionary::contains(std::string_view word) const {
+    if (slotCount_ == 0 || word.empty()) return false;
+    return table_[probe(word, hashWord(word))].offset != kEmpty;
 }
 
 } // namespace editor
@@ -1,22 +1,99 @@
 #pragma once
+#include <cstddef>
+#include <cstdint>
+#include <optional>
 #include <string>
-#include <unordered_set>
+#include <string_view>
+#include <vector>
+
+#include "io/MappedFile.h"
 
 namespace editor {
 
-// Word list backed by unordered_set for O(1) average lookup. All words are
-// lowercased at load time so lookups are case-insensitive - "This" at the
-// start of a sentence is not permanently flagged as misspelled.
+// Flat, read-mostly word set. Every word lives once in a contiguous arena
+// (NUL-separated); an open-addressing table of {arena offset, hash} slots
+// indexes it, so a lookup is one hash, a short linear probe that compares
+// stored hashes first, and one string compare - no per-word heap nodes and
+// no pointer chasing. Several times smaller than the unordered_set it
+// replaced.
+//
+// All words are lowercased at load time and lookups fold case as they hash
+// and compare - "This" at the start of a sentence is not permanently
+// flagged as misspelled, and contains() never allocates.
+//
+// The table and arena can also be written out as-is (writeBinary(), used
+// by tools/mkdict) and later mapped straight back in (loadBinary()): no
+// parsing and no hashing at startup, and the pages are shared between
+// every editor process using the same file.
 class Dictionary {
 public:
+    // Identifies the text file a binary dictionary was built from.
+    struct SourceStamp {
+        uint64_t size = 0;
+        int64_t mtimeNs = 0;
+        bool operator==(const SourceStamp& o) const { return size == o.size && mtimeNs == o.mtimeNs; }
+    };
+    static std::optional<SourceStamp> stampOf(const std::string& path);
+
+    Dictionary() = default;
+    Dictionary(Dictionary&& other) noexcept { *this = std::move(other); }
+    Dictionary& operator=(Dictionary&& other) noexcept;
+
+    // Each loader replaces the current contents.
+    // Parses a whitespace-separated word list.
     void loadFromFile(const std::string& path);
-    bool contains(const std::string& word) const;
-    size_t size() const { return words_.size(); }
+    // Maps a file written by writeBinary(). Fails (leaving the dictionary
+    // unchanged) if it is missing, malformed, from another format version,
+    // or - when `source` is given - was built from a different text file.
+    bool loadBinary(const std::string& path, const std::optional<SourceStamp>& source = std::nullopt);
+    bool writeBinary(const std::string& path, const SourceStamp& source) const;
+    // The first of `binaryPaths` that is current with `textPath` (or any
+    // valid one, if the text file is absent); otherwise the text file.
+    void load(const std::string& textPath, const std::vector<std::string>& binaryPaths);
+
+    bool contains(std::string_view word) const;
+    size_t size() const { return count_; }
+    bool mapped() const { return mapping_.valid(); }
+    // Bytes held by the arena and the table: heap capacity, or the mapping.
+    size_t bytesUsed() const {
+        return mapped() ? mapping_.size() : arena_.capacity() + slots_.capacity() * sizeof(Slot);
+    }
 
-    static std::string normalize(const std::string& word);
+    // Calls visit(std::string_view) for every (lowercased) word, in table order.
+    template <typename F>
+    void forEachWord(F&& visit) const {
+        for (size_t i = 0; i < slotCount_; ++i) {
+            if (table_[i].offset != kEmpty) visit(std::string_view(words_ + table_[i].offset));
+        }
+    }
+
+    static std::string normalize(std::string_view word);
 
 private:
-    std::unordered_set<std::string> words_;
+    struct Slot {
+        uint32_t offset; // into the arena; kEmpty marks a free slot
+        uint32_t hash;
+    };
+    static constexpr uint32_t kEmpty = UINT32_MAX;
+
+    // Owned storage, filled by loadFromFile().
+    std::vector<char> arena_;
+    std::vector<Slot> slots_; // power-of-two size, linear probing
+    // Or a file from writeBinary(), mapped read-only.
+    MappedFile mapping_;
+
+    // What lookups read: either of the above.
+    const char* words_ = nullptr;
+    size_t wordBytes_ = 0;
+    const Slot* table_ = nullptr;
+    size_t slotCount_ = 0;
+    size_t count_ = 0;
+
+    // Index of the slot holding `word`, or of the free slot where it would go.
+    size_t probe(std::string_view word, uint32_t hash) const;
+    void insert(std::string_view word);
+    void rehash(size_t slotCount);
+    void clear();
 };
 
 } // namespace editor
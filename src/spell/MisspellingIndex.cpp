@@ -0,0 +1,45 @@
+#include "spell/MisspellingIndex.h"
+
+#include <algorithm>
+
+namespace editor {
+
+namespace {
+bool rowBefore(const MisspelledSpan& s, Row row) { return s.row < row; }
+} // namespace
+
+std::pair<MisspellingIndex::const_iterator, MisspellingIndex::const_iterator>
+MisspellingIndex::rows(Row first, Row last) const {
+    auto begin = std::lower_bound(spans_.begin(), spans_.end(), first, rowBefore);
+    auto end = std::lower_bound(begin, spans_.end(), last, rowBefore);
+    return {begin, end};
+}
+
+void MisspellingIndex::applyLineChange(const LineChange& change) {
+    // Rows before the change are untouched; start at the first span the
+    // change can affect.
+    auto out = std::lower_bound(spans_.begin(), spans_.end(), change.row, rowBefore);
+    for (auto it = out; it != spans_.end(); ++it) {
+        MisspelledSpan s = *it;
+        if (remapRow(s.row, change)) *out++ = s;
+    }
+    spans_.erase(out, spans_.end());
+}
+
+void MisspellingIndex::replaceRows(const std::vector<LineRange>& rows, const MisspellingIndex& fresh) {
+    std::vector<MisspelledSpan> merged;
+    merged.reserve(spans_.size() + fresh.size());
+
+    auto kept = spans_.cbegin();
+    for (const LineRange& range : rows) {
+        auto [oldBegin, oldEnd] = this->rows(range.begin, range.end);
+        auto [newBegin, newEnd] = fresh.rows(range.begin, range.end);
+        merged.insert(merged.end(), kept, oldBegin);
+        merged.insert(merged.end(), newBegin, newEnd);
+        kept = oldEnd;
+    }
+    merged.insert(merged.end(), kept, spans_.cend());
+    spans_ = std::move(merged);
+}
+
+} // namespace editor
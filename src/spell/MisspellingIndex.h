@@ -0,0 +1,41 @@
+#pragma once
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "core/LineRanges.h"
+#include "spell/SpellChecker.h"
+
+namespace editor {
+
+// Misspelled spans kept ordered by (row, colStart), so the spans of any row
+// range are one contiguous slice found by binary search. The renderer asks
+// only for the visible rows, making a frame O(visible spans + log n) instead
+// of O(rows x spans).
+class MisspellingIndex {
+public:
+    using const_iterator = std::vector<MisspelledSpan>::const_iterator;
+
+    MisspellingIndex() = default;
+    // `spans` must already be ordered by (row, colStart) - scanRows output is.
+    explicit MisspellingIndex(std::vector<MisspelledSpan> spans) : spans_(std::move(spans)) {}
+
+    // Spans on rows [first, last).
+    std::pair<const_iterator, const_iterator> rows(Row first, Row last) const;
+
+    // Drops spans on rows the change replaced and shifts the ones below it.
+    void applyLineChange(const LineChange& change);
+    // Replaces every span on `rows` (sorted, non-overlapping) with the
+    // spans in `fresh`, which must all lie on those rows.
+    void replaceRows(const std::vector<LineRange>& rows, const MisspellingIndex& fresh);
+
+    void clear() { spans_.clear(); }
+    bool empty() const { return spans_.empty(); }
+    size_t size() const { return spans_.size(); }
+    const std::vector<MisspelledSpan>& spans() const { return spans_; }
+
+private:
+    std::vector<MisspelledSpan> spans_;
+};
+
+} // namespace editor
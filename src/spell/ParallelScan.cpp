@@ -0,0 +1,86 @@
+#include "spell/ParallelScan.h"
+
+#include <algorithm>
+
+namespace editor {
+
+namespace {
+// Small enough that an interactive task or a cancel never waits long behind
+// one chunk, large enough that per-task overhead stays negligible.
+constexpr int kMinRowsPerChunk = 4096;
+// Chunks per bulk worker, so a worker that drew cheap rows can steal more.
+constexpr int kChunksPerWorker = 4;
+
+struct ScanJob {
+    BufferSnapshot snapshot;
+    const Dictionary* dict;
+    std::shared_ptr<const std::atomic<bool>> cancelled;
+    ScanDone done;
+    std::vector<std::vector<LineRange>> chunks;
+    std::vector<std::vector<MisspelledSpan>> results; // one slot per chunk, written by its task
+    std::atomic<size_t> remaining{0};
+};
+
+void finish(ScanJob& job) {
+    size_t total = 0;
+    for (const auto& r : job.results) total += r.size();
+    std::vector<MisspelledSpan> spans;
+    spans.reserve(total);
+    for (auto& r : job.results) spans.insert(spans.end(), r.begin(), r.end());
+    job.done(std::move(spans));
+}
+} // namespace
+
+std::vector<std::vector<LineRange>> chunkRows(const std::vector<LineRange>& rows, Row rowsPerChunk) {
+    std::vector<std::vector<LineRange>> chunks;
+    std::vector<LineRange> current;
+    Row size = 0;
+    for (LineRange r : rows) {
+        while (r.begin < r.end) {
+            Row take = std::min(r.end - r.begin, rowsPerChunk - size);
+            current.push_back({r.begin, r.begin + take});
+            r.begin += take;
+            size += take;
+            if (size == rowsPerChunk) {
+                chunks.push_back(std::move(current));
+                current.clear();
+                size = 0;
+            }
+        }
+    }
+    if (!current.empty()) chunks.push_back(std::move(current));
+    return chunks;
+}
+
+void scanRowsParallel(ThreadPool& pool, Lane lane, BufferSnapshot snapshot, const Dictionary& dict,
+                      std::vector<LineRange> rows, std::shared_ptr<const std::atomic<bool>> cancelled,
+                      ScanDone done) {
+    Row lineCount = snapshot->lineCount();
+    Row total = 0;
+    for (LineRange& r : rows) {
+        r.end = std::min(r.end, lineCount);
+        if (r.end > r.begin) total += r.end - r.begin;
+    }
+    Row perChunk = total / static_cast<Row>(pool.bulkWorkerLimit() * kChunksPerWorker);
+    Row rowsPerChunk = std::max<Row>(perChunk, kMinRowsPerChunk);
+
+    auto job = std::make_shared<ScanJob>();
+    job->snapshot = std::move(snapshot);
+    job->dict = &dict;
+    job->cancelled = std::move(cancelled);
+    job->done = std::move(done);
+    job->chunks = chunkRows(rows, rowsPerChunk);
+    if (job->chunks.empty()) job->chunks.emplace_back(); // still report, with no spans
+    job->results.resize(job->chunks.size());
+    job->remaining = job->chunks.size();
+
+    for (size_t i = 0; i < job->chunks.size(); ++i) {
+        pool.post(lane, [job, i] {
+            job->results[i] = scanRows(*job->snapshot, *job->dict, job->chunks[i], *job->cancelled);
+            // acq_rel: the last finisher must see every other chunk's results.
+            if (job->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) finish(*job);
+        });
+    }
+}
+
+} // namespace editor
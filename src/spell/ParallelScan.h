@@ -0,0 +1,29 @@
+#pragma once
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "concurrent/Snapshot.h"
+#include "concurrent/ThreadPool.h"
+#include "core/LineRanges.h"
+#include "spell/Dictionary.h"
+#include "spell/SpellChecker.h"
+
+namespace editor {
+
+using ScanDone = std::function<void(std::vector<MisspelledSpan>)>;
+
+// scanRows() split into line-range chunks that run on every bulk worker of
+// `pool`. Nothing blocks: whichever chunk finishes last concatenates the
+// per-chunk results (already in row order) and calls `done` on its worker
+// thread. `done` runs exactly once, also after cancellation, when the spans
+// are partial and should be discarded. `dict` must outlive the scan.
+void scanRowsParallel(ThreadPool& pool, Lane lane, BufferSnapshot snapshot, const Dictionary& dict,
+                      std::vector<LineRange> rows, std::shared_ptr<const std::atomic<bool>> cancelled,
+                      ScanDone done);
+
+// Splits `rows` into consecutive chunks of about `rowsPerChunk` rows each.
+std::vector<std::vector<LineRange>> chunkRows(const std::vector<LineRange>& rows, Row rowsPerChunk);
+
+} // namespace editor
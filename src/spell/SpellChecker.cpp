@@ -1,5 +1,6 @@
 #include "spell/SpellChecker.h"
 
+#include <algorithm>
 #include <cctype>
 
 namespace editor {
@@ -8,15 +9,16 @@ namespace {
 bool isWordChar(char c) {
     return std::isalnum(static_cast<unsigned char>(c)) || c == '\'';
 }
+
+// Rows visited between checks of the cancellation flag.
+constexpr int kRowsPerCancelCheck = 256;
 } // namespace
 
-std::vector<MisspelledSpan> scanBuffer(const std::vector<std::string>& lines, const Dictionary& dict,
-                                        const std::atomic<bool>& cancelled) {
+std::vector<MisspelledSpan> scanRows(const TextSnapshot& lines, const Dictionary& dict,
+                                      const std::vector<LineRange>& rows, const std::atomic<bool>& cancelled) {
     std::vector<MisspelledSpan> spans;
 
-    for (int r = 0; r < static_cast<int>(lines.size()); ++r) {
-        if (cancelled) return {};
-        const std::string& line = lines[r];
+    auto scanLine = [&](Row r, std::string_view line) {
         int i = 0;
         int n = static_cast<int>(line.size());
         while (i < n) {
@@ -26,11 +28,24 @@ std::vector<MisspelledSpan> scanBuffer(const std::vector<std::string>& lines, co
             }
             int start = i;
             while (i < n && isWordChar(line[i])) i++;
-            std::string word = line.substr(start, i - start);
-            if (!dict.contains(word)) spans.push_back({r, start, i});
+            if (!dict.contains(line.substr(start, i - start))) spans.push_back({r, start, i});
+        }
+    };
+
+    Row lineCount = lines.lineCount();
+    for (const LineRange& range : rows) {
+        Row end = std::min(range.end, lineCount);
+        for (Row first = range.begin; first < end; first += kRowsPerCancelCheck) {
+            if (cancelled) return {};
+            lines.forEachLine(first, std::min(end, first + kRowsPerCancelCheck), scanLine);
         }
     }
     return spans;
 }
 
+std::vector<MisspelledSpan> scanBuffer(const TextSnapshot& lines, const Dictionary& dict,
+                                        const std::atomic<bool>& cancelled) {
+    return scanRows(lines, dict, {{0, lines.lineCount()}}, cancelled);
+}
+
 } // namespace editor
@@ -3,19 +3,27 @@
 #include <string>
 #include <vector>
 
+#include "core/LineRanges.h"
+#include "core/TextSnapshot.h"
 #include "spell/Dictionary.h"
 
 namespace editor {
 
 struct MisspelledSpan {
-    int row;
+    Row row;
     int colStart;
     int colEnd;
 };
 
 // Tokenizes every line and flags words absent from the dictionary. Intended
 // to run on a worker thread against an immutable snapshot of the buffer.
-std::vector<MisspelledSpan> scanBuffer(const std::vector<std::string>& lines, const Dictionary& dict,
+std::vector<MisspelledSpan> scanBuffer(const TextSnapshot& lines, const Dictionary& dict,
                                         const std::atomic<bool>& cancelled);
 
+// Same as scanBuffer, restricted to `rows` (sorted, non-overlapping). Spans
+// come back sorted by row. This is what keeps rescans after an edit
+// proportional to the rows the edit touched rather than to the document.
+std::vector<MisspelledSpan> scanRows(const TextSnapshot& lines, const Dictionary& dict,
+                                      const std::vector<LineRange>& rows, const std::atomic<bool>& cancelled);
+
 } // namespace editor
@@ -2,12 +2,124 @@
 
 #include <algorithm>
 #include <cctype>
+#include <cstdlib>
 
 namespace editor {
 
-SuggestionResult suggest(const Dictionary& dict, const std::string& word, const std::atomic<bool>& cancelled) {
+namespace {
+constexpr size_t kMaxSuggestions = 8;
+
+inline char fold(char c) {
+    return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+// Neighbouring keys on a QWERTY layout. Positions are in quarter-key
+// units with the usual row stagger, so "within a key and a bit, one row
+// up or down" covers the keys around each one.
+bool adjacentKeys(char a, char b) {
+    static const char* const rows[] = {"qwertyuiop", "asdfghjkl", "zxcvbnm"};
+    static const int stagger[] = {0, 1, 3};
+    int ax = -1, ay = 0, bx = -1, by = 0;
+    for (int r = 0; r < 3; ++r) {
+        for (int c = 0; rows[r][c]; ++c) {
+            if (rows[r][c] == a) ax = c * 4 + stagger[r], ay = r;
+            if (rows[r][c] == b) bx = c * 4 + stagger[r], by = r;
+        }
+    }
+    return ax >= 0 && bx >= 0 && a != b && std::abs(ay - by) <= 1 && std::abs(ax - bx) <= 4;
+}
+
+// Over the part where the two words differ: a substitution by a
+// neighbouring key costs 1, any other changed, added or dropped letter 2.
+int keyboardCost(std::string_view typed, std::string_view candidate) {
+    size_t prefix = 0;
+    while (prefix < typed.size() && prefix < candidate.size() && fold(typed[prefix]) == fold(candidate[prefix])) {
+        ++prefix;
+    }
+    typed.remove_prefix(prefix);
+    candidate.remove_prefix(prefix);
+    while (!typed.empty() && !candidate.empty() && fold(typed.back()) == fold(candidate.back())) {
+        typed.remove_suffix(1);
+        candidate.remove_suffix(1);
+    }
+    if (typed.size() != candidate.size()) return 2 * static_cast<int>(std::max(typed.size(), candidate.size()));
+    int cost = 0;
+    for (size_t i = 0; i < typed.size(); ++i) {
+        char a = fold(typed[i]), b = fold(candidate[i]);
+        if (a != b) cost += adjacentKeys(a, b) ? 1 : 2;
+    }
+    return cost;
+}
+
+bool ranksBefore(const SuggestionScore& a, std::string_view aw, const SuggestionScore& b, std::string_view bw) {
+    if (a.distance != b.distance) return a.distance < b.distance;
+    if (a.frequency != b.frequency) return a.frequency > b.frequency;
+    if (a.keyboardCost != b.keyboardCost) return a.keyboardCost < b.keyboardCost;
+    return aw < bw;
+}
+
+// The best kMaxSuggestions candidates offered so far. A max-heap with the
+// worst kept candidate on top: a new one costs a compare against it, and
+// only one that beats it is copied in.
+class TopSuggestions {
+public:
+    TopSuggestions(std::string_view typed, const WordFrequencies* frequencies)
+        : typed_(typed), frequencies_(frequencies) {
+        heap_.reserve(kMaxSuggestions);
+    }
+
+    void offer(std::string_view candidate, int distance) {
+        SuggestionScore score{distance, frequencies_ ? frequencies_->count(candidate) : 0,
+                              keyboardCost(typed_, candidate)};
+        // The same word can be reached by two different edits.
+        for (const Entry& e : heap_) {
+            if (e.word == candidate) return;
+        }
+        if (heap_.size() == kMaxSuggestions) {
+            const Entry& worst = heap_.front();
+            if (!ranksBefore(score, candidate, worst.score, worst.word)) return;
+            std::pop_heap(heap_.begin(), heap_.end(), worse);
+            heap_.pop_back();
+        }
+        heap_.push_back({score, std::string(candidate)});
+        std::push_heap(heap_.begin(), heap_.end(), worse);
+    }
+
+    void finish(SuggestionResult& result) {
+        std::sort_heap(heap_.begin(), heap_.end(), worse); // best first
+        for (Entry& e : heap_) {
+            result.suggestions.push_back(std::move(e.word));
+            result.scores.push_back(e.score);
+        }
+        heap_.clear();
+    }
+
+private:
+    struct Entry {
+        SuggestionScore score;
+        std::string word;
+    };
+    // Heap order: "less" means ranks before, so the top is the worst.
+    static bool worse(const Entry& a, const Entry& b) { return ranksBefore(a.score, a.word, b.score, b.word); }
+
+    std::string_view typed_;
+    const WordFrequencies* frequencies_;
+    std::vector<Entry> heap_;
+};
+
+// Whether walking `rest` from `s` ends on a whole word.
+bool completes(const Dawg& dawg, Dawg::State s, std::string_view rest) {
+    for (char c : rest) {
+        if (!dawg.step(s, c)) return false;
+    }
+    return s.word;
+}
+} // namespace
+
+SuggestionResult suggest(const Dictionary& dict, std::string_view word, const std::atomic<bool>& cancelled,
+                         const WordFrequencies* frequencies) {
     SuggestionResult result;
-    result.word = word;
+    result.word = std::string(word);
     if (word.empty()) return result;
 
     if (dict.contains(word)) {
@@ -15,44 +127,133 @@ SuggestionResult suggest(const Dictionary& dict, const std::string& word, const
         return result;
     }
 
+    // Every candidate is built in one buffer with room for the longest
+    // (insertion) edit, so probing ~54n candidates allocates nothing; only
+    // hits are copied out.
+    TopSuggestions top(word, frequencies);
+    std::string mod;
+    mod.reserve(word.size() + 1);
+    auto check = [&] {
+        if (dict.contains(mod)) top.offer(mod, 1);
+    };
+
     // Substitution: swap each letter for every other letter.
+    mod.assign(word);
     for (size_t i = 0; i < word.size() && !cancelled; ++i) {
         for (char c = 'a'; c <= 'z'; ++c) {
             if (c == std::tolower(static_cast<unsigned char>(word[i]))) continue;
-            std::string mod = word;
             mod[i] = c;
-            if (dict.contains(mod)) result.suggestions.push_back(mod);
+            check();
         }
+        mod[i] = word[i];
     }
 
     // Omission: drop each letter.
     for (size_t i = 0; i < word.size() && !cancelled; ++i) {
-        std::string mod = word.substr(0, i) + word.substr(i + 1);
-        if (dict.contains(mod)) result.suggestions.push_back(mod);
+        mod.assign(word);
+        mod.erase(i, 1);
+        check();
     }
 
     // Insertion: add a letter at each position.
     for (size_t i = 0; i <= word.size() && !cancelled; ++i) {
+        mod.assign(word);
+        mod.insert(i, 1, 'a');
         for (char c = 'a'; c <= 'z'; ++c) {
-            std::string mod = word.substr(0, i) + c + word.substr(i);
-            if (dict.contains(mod)) result.suggestions.push_back(mod);
+            mod[i] = c;
+            check();
         }
     }
 
     // Reversal: swap each pair of adjacent letters.
-    if (word.size() > 1) {
-        for (size_t i = 0; i + 1 < word.size() && !cancelled; ++i) {
-            std::string mod = word;
-            std::swap(mod[i], mod[i + 1]);
-            if (dict.contains(mod)) result.suggestions.push_back(mod);
+    mod.assign(word);
+    for (size_t i = 0; i + 1 < word.size() && !cancelled; ++i) {
+        std::swap(mod[i], mod[i + 1]);
+        check();
+        std::swap(mod[i], mod[i + 1]);
+    }
+
+    top.finish(result);
+    return result;
+}
+
+SuggestionResult suggest(const Dawg& dawg, std::string_view word, const std::atomic<bool>& cancelled,
+                         const WordFrequencies* frequencies) {
+    SuggestionResult result;
+    result.word = std::string(word);
+    if (word.empty()) return result;
+
+    if (dawg.contains(word)) {
+        result.correct = true;
+        return result;
+    }
+
+    // Hits are spelled out in `mod` only once found: `word` with one edit,
+    // keeping the caller's case for the untouched letters, as above.
+    TopSuggestions top(word, frequencies);
+    std::string mod;
+    mod.reserve(word.size() + 1);
+    auto hit = [&](auto&& edit) {
+        mod.assign(word);
+        edit(mod);
+        top.offer(mod, 1);
+    };
+
+    // `here` is the state after word[0, i): every edit at position i starts
+    // from it.
+    Dawg::State here = dawg.start();
+    for (size_t i = 0; i <= word.size() && !cancelled; ++i) {
+        std::string_view rest = word.substr(i);
+        char own = i < word.size() ? std::tolower(static_cast<unsigned char>(word[i])) : '\0';
+
+        dawg.forEachEdge(here, [&](char c, Dawg::State next) {
+            if (c < 'a' || c > 'z') return; // same alphabet as the brute-force search
+            // Insertion of c before word[i].
+            if (completes(dawg, next, rest)) hit([&](std::string& m) { m.insert(i, 1, c); });
+            // Substitution of word[i] by c.
+            if (i < word.size() && c != own && completes(dawg, next, rest.substr(1))) {
+                hit([&](std::string& m) { m[i] = c; });
+            }
+        });
+        if (i == word.size()) break;
+
+        // Omission of word[i].
+        if (completes(dawg, here, rest.substr(1))) hit([&](std::string& m) { m.erase(i, 1); });
+        // Reversal of word[i] and word[i + 1].
+        Dawg::State swapped = here;
+        if (rest.size() >= 2 && dawg.step(swapped, rest[1]) && dawg.step(swapped, rest[0]) &&
+            completes(dawg, swapped, rest.substr(2))) {
+            hit([&](std::string& m) { std::swap(m[i], m[i + 1]); });
         }
+
+        // No word starts with word[0, i]: nothing further along can match.
+        if (!dawg.step(here, word[i])) break;
     }
 
-    std::sort(result.suggestions.begin(), result.suggestions.end());
-    result.suggestions.erase(std::unique(result.suggestions.begin(), result.suggestions.end()),
-                              result.suggestions.end());
-    if (result.suggestions.size() > 8) result.suggestions.resize(8);
+    top.finish(result);
+    return result;
+}
+
+SuggestionResult suggest(const DeletionIndex& index, std::string_view word, const std::atomic<bool>& cancelled,
+                         const WordFrequencies* frequencies) {
+    SuggestionResult result;
+    result.word = std::string(word);
+    if (word.empty()) return result;
 
+    std::vector<DeletionIndex::Match> matches = index.matches(word, DeletionIndex::kMaxDistance, cancelled);
+    bool capitalized = std::isupper(static_cast<unsigned char>(word[0]));
+    TopSuggestions top(word, frequencies);
+    std::string cased;
+    for (const DeletionIndex::Match& m : matches) {
+        if (m.distance == 0) {
+            result.correct = true;
+            return result;
+        }
+        cased.assign(m.word);
+        if (capitalized) cased[0] = static_cast<char>(std::toupper(static_cast<unsigned char>(cased[0])));
+        top.offer(cased, m.distance);
+    }
+    top.finish(result);
     return result;
 }
 
@@ -1,23 +1,54 @@
 #pragma once
 #include <atomic>
 #include <string>
+#include <string_view>
 #include <vector>
 
+#include "spell/Dawg.h"
+#include "spell/DeletionIndex.h"
 #include "spell/Dictionary.h"
+#include "spell/WordFrequencies.h"
 
 namespace editor {
 
+// Why a suggestion ranks where it does. Compared in this order.
+struct SuggestionScore {
+    int distance = 0;       // edits from the typed word; fewer first
+    uint32_t frequency = 0; // from the frequency table, 0 if unlisted; higher first
+    int keyboardCost = 0;   // how unlike a slip of the finger the edits are; lower first
+};
+
 struct SuggestionResult {
     std::string word;
     bool correct = false;
-    std::vector<std::string> suggestions;
+    std::vector<std::string> suggestions; // best first
+    std::vector<SuggestionScore> scores;  // one per suggestion
 };
 
+// Every suggest() keeps the best eight candidates by SuggestionScore (then
+// alphabetically) in a bounded heap as they are found, rather than
+// collecting and sorting them all. `frequencies` is optional.
+
 // Substitution / omission / insertion / reversal suggestions - the same four
 // strategies as the original spellCheck(), fixed at the source: an empty
 // `word` returns immediately instead of underflowing `word.length() - 1`.
 // Runs off the UI thread; `cancelled` is checked between passes so a stale
 // request (the user moved on to another word) can bail out early.
-SuggestionResult suggest(const Dictionary& dict, const std::string& word, const std::atomic<bool>& cancelled);
+SuggestionResult suggest(const Dictionary& dict, std::string_view word, const std::atomic<bool>& cancelled,
+                         const WordFrequencies* frequencies = nullptr);
+
+// Same edits and the same result, but generated by walking the DAWG: the
+// prefix before each edit point is walked once and shared by every edit
+// there, each candidate is abandoned at its first letter that leads out of
+// the dictionary, and once the word's own prefix does, no later edit point
+// is tried at all.
+SuggestionResult suggest(const Dawg& dawg, std::string_view word, const std::atomic<bool>& cancelled,
+                         const WordFrequencies* frequencies = nullptr);
+
+// Everything within Damerau-Levenshtein distance 2, from the deletion
+// index. A capitalized word gets capitalized suggestions, as the in-place
+// edits above would give it.
+SuggestionResult suggest(const DeletionIndex& index, std::string_view word, const std::atomic<bool>& cancelled,
+                         const WordFrequencies* frequencies = nullptr);
 
 } // namespace editor
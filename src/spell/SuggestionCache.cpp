@@ -0,0 +1,52 @@
+#include "spell/SuggestionCache.h"
+
+#include <cctype>
+#include <utility>
+
+#include "spell/Dictionary.h"
+
+namespace editor {
+
+std::optional<SuggestionResult> SuggestionCache::get(std::string_view word) {
+    auto it = byWord_.find(Dictionary::normalize(word));
+    if (it == byWord_.end()) {
+        misses_++;
+        return std::nullopt;
+    }
+    hits_++;
+    entries_.splice(entries_.begin(), entries_, it->second);
+    return restyle(*it->second, word);
+}
+
+bool SuggestionCache::contains(std::string_view word) const {
+    return byWord_.count(Dictionary::normalize(word)) > 0;
+}
+
+void SuggestionCache::put(SuggestionResult result) {
+    if (capacity_ == 0) return;
+    auto it = byWord_.find(result.word);
+    if (it != byWord_.end()) {
+        *it->second = std::move(result);
+        entries_.splice(entries_.begin(), entries_, it->second);
+        return;
+    }
+    if (byWord_.size() == capacity_) {
+        byWord_.erase(entries_.back().word);
+        entries_.pop_back();
+    }
+    entries_.push_front(std::move(result));
+    byWord_.emplace(entries_.front().word, entries_.begin());
+}
+
+SuggestionResult SuggestionCache::restyle(const SuggestionResult& stored, std::string_view typed) {
+    SuggestionResult out = stored;
+    out.word = std::string(typed);
+    if (!typed.empty() && std::isupper(static_cast<unsigned char>(typed[0]))) {
+        for (std::string& s : out.suggestions) {
+            if (!s.empty()) s[0] = static_cast<char>(std::toupper(static_cast<unsigned char>(s[0])));
+        }
+    }
+    return out;
+}
+
+} // namespace editor
@@ -0,0 +1,48 @@
+#pragma once
+#include <cstddef>
+#include <list>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "spell/Suggester.h"
+
+namespace editor {
+
+// Recently computed suggestions, keyed by lowercased word and evicted
+// least-recently-used first. Results are stored as computed for the
+// lowercase word and restyled on the way out, so "Wrold" and "wrold"
+// share an entry. Main thread only - workers hand results over through
+// the event queue like everything else.
+class SuggestionCache {
+public:
+    explicit SuggestionCache(size_t capacity = 512) : capacity_(capacity) {}
+
+    // The entry for `word` (any case), restyled for it, and marked most
+    // recently used. Counts towards hits or misses.
+    std::optional<SuggestionResult> get(std::string_view word);
+    // Whether `word` has an entry; doesn't touch recency or the counters.
+    bool contains(std::string_view word) const;
+    // Stores `result`, which must be for a lowercase word (result.word),
+    // replacing any entry for that word.
+    void put(SuggestionResult result);
+
+    // `stored` as suggest() would have answered `typed`: a capitalized
+    // word gets capitalized suggestions.
+    static SuggestionResult restyle(const SuggestionResult& stored, std::string_view typed);
+
+    size_t size() const { return byWord_.size(); }
+    size_t capacity() const { return capacity_; }
+    long long hits() const { return hits_; }
+    long long misses() const { return misses_; }
+
+private:
+    size_t capacity_;
+    std::list<SuggestionResult> entries_; // most recently used first
+    std::unordered_map<std::string, std::list<SuggestionResult>::iterator> byWord_;
+    long long hits_ = 0;
+    long long misses_ = 0;
+};
+
+} // namespace editor
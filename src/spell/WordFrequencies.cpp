@@ -0,0 +1,70 @@
+#include "spell/WordFrequencies.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+#include "spell/Dictionary.h"
+
+namespace editor {
+
+namespace {
+inline char fold(char c) {
+    return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+// `stored` (lowercase) < `word` with `word` case-folded.
+bool lessFolded(const std::string& stored, std::string_view word) {
+    size_t n = std::min(stored.size(), word.size());
+    for (size_t i = 0; i < n; ++i) {
+        unsigned char a = static_cast<unsigned char>(stored[i]);
+        unsigned char b = static_cast<unsigned char>(fold(word[i]));
+        if (a != b) return a < b;
+    }
+    return stored.size() < word.size();
+}
+} // namespace
+
+void WordFrequencies::build(std::vector<std::pair<std::string, uint32_t>> entries) {
+    for (auto& e : entries) e.first = Dictionary::normalize(e.first);
+    std::sort(entries.begin(), entries.end());
+    entries_.clear();
+    for (auto& e : entries) {
+        if (e.first.empty()) continue;
+        if (!entries_.empty() && entries_.back().first == e.first) {
+            uint64_t sum = uint64_t(entries_.back().second) + e.second;
+            entries_.back().second = static_cast<uint32_t>(std::min<uint64_t>(sum, UINT32_MAX));
+        } else {
+            entries_.push_back(std::move(e));
+        }
+    }
+    entries_.shrink_to_fit();
+}
+
+bool WordFrequencies::loadFromFile(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) return false;
+    std::vector<std::pair<std::string, uint32_t>> entries;
+    std::string line, word;
+    while (std::getline(file, line)) {
+        std::istringstream fields(line);
+        unsigned long long n = 0;
+        if (fields >> word >> n) {
+            entries.emplace_back(word, static_cast<uint32_t>(std::min<unsigned long long>(n, UINT32_MAX)));
+        }
+    }
+    build(std::move(entries));
+    return true;
+}
+
+uint32_t WordFrequencies::count(std::string_view word) const {
+    auto it = std::lower_bound(entries_.begin(), entries_.end(), word,
+                               [](const auto& e, std::string_view w) { return lessFolded(e.first, w); });
+    if (it == entries_.end() || it->first.size() != word.size()) return 0;
+    for (size_t i = 0; i < word.size(); ++i) {
+        if (it->first[i] != fold(word[i])) return 0;
+    }
+    return it->second;
+}
+
+} // namespace editor
@@ -0,0 +1,30 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace editor {
+
+// How common each word is, for ranking suggestions. Optional: without a
+// table every count is 0 and ranking falls through to the next key.
+// Sorted (word, count) pairs; count() folds case as it binary-searches,
+// so it never allocates. Immutable once loaded.
+class WordFrequencies {
+public:
+    // Replaces the contents. Words are lowercased; repeats add up.
+    void build(std::vector<std::pair<std::string, uint32_t>> entries);
+    // Lines of "word count" (the common word-frequency list format);
+    // anything after the count is ignored. False if the file can't be read.
+    bool loadFromFile(const std::string& path);
+
+    uint32_t count(std::string_view word) const;
+    size_t size() const { return entries_.size(); }
+
+private:
+    std::vector<std::pair<std::string, uint32_t>> entries_; // by word
+};
+
+} // namespace editor
@@ -1,9 +1,19 @@
 #include "ui/Editor.h"
 
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
 #include <ncurses.h>
+#include <poll.h>
+#include <unistd.h>
 
 #include "concurrent/Snapshot.h"
+#include "concurrent/Task.h"
 #include "io/FileIO.h"
+#include "io/ParallelLoad.h"
+#include "spell/ParallelScan.h"
 #include "spell/SpellChecker.h"
 #include "spell/Suggester.h"
 #include "ui/Prompt.h"
@@ -13,42 +23,104 @@ namespace editor {
 
 using namespace std::chrono_literals;
 
-Editor::Editor(std::string initialFile) : initialFile_(std::move(initialFile)) {}
+namespace {
+constexpr auto kScanDebounce = 150ms;
+constexpr auto kAutosaveIdle = 3s;
+constexpr auto kAutosaveInterval = 5s;
+// Misspellings one worker task looks up ahead of time, at most.
+constexpr size_t kSpeculateBatch = 64;
+// Completions are offered once a word is this long, this many at a time.
+constexpr int kMinCompletionPrefix = 2;
+constexpr size_t kMaxCompletions = 6;
+// Files this big open in large-file mode (StorageKind::LargeFile), which
+// keeps memory proportional to the edits and the viewport: coarse pieces,
+// spell checking only around the viewport, no document-wide word list.
+constexpr size_t kLargeFileBytes = size_t(1) << 30;
+
+// Keys whose handler (may) change the text, or save a copy of it.
+bool changesText(int ch) {
+    switch (ch) {
+        case KEY_ENTER: case '\n': case '\r':
+        case KEY_BACKSPACE: case 127: case 8:
+        case KEY_DC:
+        case 24: case 22: case 26: case 25: // cut, paste, undo, redo
+        case 18: case 4: case 5:            // save, save as, replace
+            return true;
+        default:
+            return ch >= 32 && ch <= 126;
+    }
+}
+
+// Where to look for a prebuilt dictionary.bin: the working directory (next
+// to dictionary.txt), then beside the executable, where the build puts it.
+std::vector<std::string> binaryDictionaryPaths() {
+    std::vector<std::string> paths{"dictionary.bin"};
+    char exe[PATH_MAX];
+    ssize_t n = readlink("/proc/self/exe", exe, sizeof exe - 1);
+    if (n > 0) {
+        std::string dir(exe, static_cast<size_t>(n));
+        dir.erase(dir.rfind('/') + 1);
+        paths.push_back(dir + "dictionary.bin");
+    }
+    return paths;
+}
+} // namespace
+
+Editor::Editor(std::string initialFile)
+    : initialFile_(std::move(initialFile)), showStats_(std::getenv("TEXTEDITOR_STATS") != nullptr) {}
 
 void Editor::run() {
-    timeout(16); // ~60fps poll: getch() returns ERR instead of blocking, so
-                 // the loop can drain worker events between keystrokes.
+    nodelay(stdscr, TRUE); // getch() only reads what poll() said is there
 
     // Async dictionary load: the editor is interactive immediately, and
-    // spell features light up via dictReady_ once this completes. The
-    // std::atomic store/load pair below is what makes handing an
-    // unordered_set built entirely on a worker thread over to the main
+    // spell features light up via dictReady_ once this completes - almost
+    // at once when a current dictionary.bin can be mapped, after a parse
+    // of dictionary.txt otherwise. The
+    // std::atomic store/load pair below is what makes handing a
+    // dictionary built entirely on a worker thread over to the main
     // thread safe without a mutex - the dictionary is never mutated again
     // after dictReady_ is set.
-    pool_.submit([this] {
-        dictionary_.loadFromFile("dictionary.txt");
+    pool_.post(Lane::IO, [this] {
+        auto start = std::chrono::steady_clock::now();
+        dictionary_.load("dictionary.txt", binaryDictionaryPaths());
+        std::chrono::duration<double, std::milli> took = std::chrono::steady_clock::now() - start;
+        frequencies_.loadFromFile("frequencies.txt"); // optional; ranks suggestions
         dictReady_ = true;
-        events_.push(DictionaryLoadedEvent{dictionary_.size()});
-        return 0;
+        events_.push(DictionaryLoadedEvent{dictionary_.size(), took.count()});
+
+        // Then the structures suggestions use, built from the same words
+        // on the background lane. Until each is published (dawgReady_,
+        // indexReady_), suggestions use the one before it.
+        pool_.post(Lane::Background, [this] {
+            std::vector<std::string> words;
+            words.reserve(dictionary_.size());
+            dictionary_.forEachWord([&words](std::string_view w) { words.emplace_back(w); });
+            dawg_.build(words);
+            dawgReady_ = true;
+            completer_.build(words, &frequencies_);
+            completerReady_ = true;
+            deletions_.build(words);
+            indexReady_ = true;
+            events_.push(SuggestionIndexReadyEvent{});
+        });
     });
 
     if (!initialFile_.empty()) {
-        std::string path = initialFile_;
-        pool_.submit([this, path] {
-            LoadResult r = loadFile(path);
-            events_.push(LoadCompleteEvent{r.success, r.lines, path, r.error, r.trailingNewline});
-            return 0;
-        });
+        startLoad(initialFile_);
     }
 
     lastEditTime_ = std::chrono::steady_clock::now();
     lastAutosave_ = lastEditTime_;
-    auto lastDraw = std::chrono::steady_clock::now();
 
+    // Event-driven: the loop sleeps in poll() until a key arrives, a worker
+    // pushes an event, or the debounce/autosave deadline comes due, and
+    // redraws only when one of those changed something. An idle editor
+    // makes no wakeups at all.
+    bool acted = true; // first frame
     while (running_) {
-        int ch = getch();
-        bool acted = false;
-        if (ch != ERR) {
+        checkMappedFile(); // before keys read the text
+        // Everything already typed, so a burst of keys costs one frame.
+        for (int ch; running_ && (ch = getch()) != ERR;) {
             handleKey(ch);
             acted = true;
         }
@@ -56,24 +128,73 @@ void Editor::run() {
         maybeTriggerScan();
         maybeAutosave();
 
-        auto now = std::chrono::steady_clock::now();
-        if (acted || now - lastDraw > 200ms) {
-            draw();
-            lastDraw = now;
-        }
+        if (acted) draw();
+        acted = false;
+        if (running_) waitForActivity();
+    }
+
+    // The pool finishes queued work before it joins; don't make quitting
+    // wait for results nobody will see.
+    cancelPendingSuggestion();
+    cancelPendingScan();
+    speculateCancelFlag_->store(true);
+}
+
+void Editor::waitForActivity() {
+    int timeoutMs = -1;
+    if (auto deadline = nextDeadline()) {
+        auto wait = *deadline - std::chrono::steady_clock::now();
+        // Round up: waking a hair early would find nothing due and spin.
+        timeoutMs = wait <= 0ms ? 0 : static_cast<int>(std::chrono::ceil<std::chrono::milliseconds>(wait).count());
     }
+    pollfd fds[] = {{STDIN_FILENO, POLLIN, 0}, {events_.wakeFd(), POLLIN, 0}};
+    // EINTR (e.g. SIGWINCH) just falls through: getch() then reports KEY_RESIZE.
+    poll(fds, 2, timeoutMs);
+}
+
+// The earliest moment maybeTriggerScan() or maybeAutosave() will act with no
+// further input, or nullopt if neither is waiting on the clock.
+std::optional<std::chrono::steady_clock::time_point> Editor::nextDeadline() const {
+    std::optional<std::chrono::steady_clock::time_point> next;
+    auto consider = [&next](std::chrono::steady_clock::time_point t) {
+        if (!next || t < *next) next = t;
+    };
+    if (scanPending_ && dictReady_) consider(lastEditTime_ + kScanDebounce);
+    if (doc_.dirty() && doc_.hasFilename() && !changedOnDisk_) {
+        consider(std::max(lastEditTime_ + kAutosaveIdle, lastAutosave_ + kAutosaveInterval));
+    }
+    return next;
 }
 
 void Editor::markEdited() {
     lastEditTime_ = std::chrono::steady_clock::now();
-    docVersion_++;
     scanPending_ = true;
+    trackLineChanges();
+}
+
+// Keeps the span list and the set of rows still to be scanned lined up with
+// the buffer's rows: spans on rows an edit replaced are dropped (those rows
+// become unscanned), spans below it shift with the text.
+void Editor::trackLineChanges() {
+    for (const LineChange& change : doc_.buffer().takeChanges()) {
+        misspellings_.applyLineChange(change);
+        unscannedRows_.applyChange(change);
+        if (activeScan_) changeLog_.push_back(change);
+    }
 }
 
 void Editor::cancelPendingSuggestion() {
     if (suggestCancelFlag_) suggestCancelFlag_->store(true);
 }
 
+void Editor::cancelPendingScan() {
+    if (!activeScan_) return;
+    scanCancelFlag_->store(true);
+    scanStats_.cancelled++;
+    activeScan_ = 0;
+    changeLog_.clear();
+}
+
 void Editor::requestSuggestions() {
     if (!dictReady_) {
         statusMessage_ = "Dictionary still loading...";
@@ -86,19 +207,120 @@ void Editor::requestSuggestions() {
     }
 
     cancelPendingSuggestion(); // tell any in-flight request to stop
-    auto myFlag = std::make_shared<std::atomic<bool>>(false);
-    suggestCancelFlag_ = myFlag;
     int myVersion = ++suggestVersion_;
     std::string w = word.text;
 
-    pool_.submit([this, w, myVersion, myFlag] {
-        auto result = suggest(dictionary_, w, *myFlag);
+    // Only the deletion index's answers are cached: the earlier fallbacks
+    // see fewer candidates, and would go on being served once it is up.
+    if (indexReady_) {
+        if (auto cached = suggestionCache_.get(w)) {
+            lastSuggestions_ = std::move(*cached);
+            return;
+        }
+    }
+
+    auto myFlag = std::make_shared<std::atomic<bool>>(false);
+    suggestCancelFlag_ = myFlag;
+    pool_.post(Lane::Interactive, [this, w, myVersion, myFlag] {
+        if (indexReady_) {
+            auto result = suggest(deletions_, Dictionary::normalize(w), *myFlag, &frequencies_);
+            events_.push(SuggestEvent{myVersion, std::move(result), !*myFlag, w});
+            return;
+        }
+        auto result = dawgReady_ ? suggest(dawg_, w, *myFlag, &frequencies_)
+                                 : suggest(dictionary_, w, *myFlag, &frequencies_);
         events_.push(SuggestEvent{myVersion, std::move(result)});
-        return 0;
     });
 }
 
+// Works out suggestions for the misspellings on and around the screen -
+// a screenful above and below - before anyone asks, so Ctrl+W on one is
+// answered from the cache. Runs after each applied scan, on the background
+// lane, skipping words already cached or already being looked up.
+void Editor::speculateSuggestions() {
+    if (!indexReady_) return;
+    int rows = viewportRows();
+    auto [first, last] = misspellings_.rows(std::max<Row>(0, view_.topLine - rows), view_.topLine + 2 * rows);
+    if (first == last) return;
+    std::vector<std::string> words;
+    // The rows the spans are on, read in one walk rather than a lookup per
+    // row - which in a large file means a search through a piece.
+    auto it = first;
+    doc_.buffer().forEachLine(first->row, std::prev(last)->row + 1, [&](Row row, std::string_view line) {
+        for (; it != last && it->row == row && words.size() < kSpeculateBatch; ++it) {
+            if (it->colEnd > static_cast<int>(line.size()) || it->colStart >= it->colEnd) continue;
+            std::string w = Dictionary::normalize(line.substr(it->colStart, it->colEnd - it->colStart));
+            if (suggestionCache_.contains(w) || !speculating_.insert(w).second) continue;
+            words.push_back(std::move(w));
+        }
+    });
+    if (words.empty()) return;
+
+    pool_.post(Lane::Background, [this, words = std::move(words), flag = speculateCancelFlag_] {
+        SpeculativeSuggestionsEvent e;
+        for (const std::string& w : words) {
+            if (*flag) return; // quitting
+            e.results.push_back(suggest(deletions_, w, *flag, &frequencies_));
+        }
+        events_.push(std::move(e));
+    });
+}
+
+// Completions for the word just typed, if the cursor is at the end of one.
+// Queries take well under a millisecond, so there is nothing to cancel;
+// a result that arrives after the next key is simply dropped.
+void Editor::requestCompletions() {
+    if (!completerReady_) return;
+    Position cur = doc_.buffer().cursor();
+    WordSpan word = doc_.buffer().wordAt(cur);
+    if (word.end != cur || cur.col - word.start.col < kMinCompletionPrefix) return;
+
+    int myVersion = ++completeVersion_;
+    auto complete = [this, prefix = word.text, at = word.start, myVersion, words = bufferWords_] {
+        events_.push(CompletionEvent{myVersion, at, completer_.complete(prefix, kMaxCompletions, words.get())});
+    };
+    // Posted on every key; it should be one allocation, not two.
+    static_assert(sizeof(complete) <= Task::kInlineBytes, "completion task no longer fits a Task inline");
+    pool_.post(Lane::Interactive, std::move(complete));
+}
+
+void Editor::acceptCompletion() {
+    const std::string& pick = completions_.items[completions_.selected];
+    int typed = doc_.buffer().cursor().col - completions_.at.col;
+    if (typed >= 0 && typed < static_cast<int>(pick.size())) {
+        for (char c : pick.substr(typed)) doc_.typeChar(c);
+        markEdited();
+    }
+    dismissCompletions();
+}
+
+void Editor::dismissCompletions() {
+    ++completeVersion_;
+    completions_.items.clear();
+}
+
 void Editor::handleKey(int ch) {
+    // While the popup is up, Tab takes the highlighted completion and
+    // Ctrl+N / Ctrl+P move the highlight. Any other key closes it; typing
+    // more of the word opens it again.
+    if (!completions_.items.empty()) {
+        int count = static_cast<int>(completions_.items.size());
+        switch (ch) {
+            case '\t': acceptCompletion(); return;
+            case 14: completions_.selected = (completions_.selected + 1) % count; return;         // Ctrl+N
+            case 16: completions_.selected = (completions_.selected + count - 1) % count; return; // Ctrl+P
+            default: break;
+        }
+    }
+    dismissCompletions();
+
+    // Until a file has streamed in completely, only keys that leave the
+    // text alone - moving, selecting, copying, finding - do anything.
+    if (loadingFile() && changesText(ch)) {
+        statusMessage_ = "Still loading - read-only until the whole file is in.";
+        return;
+    }
+
     switch (ch) {
         case 27: // ESC: quit
             if (confirmQuitIfDirty()) running_ = false;
@@ -121,6 +343,7 @@ void Editor::handleKey(int ch) {
         case KEY_BACKSPACE: case 127: case 8:
             doc_.backspace();
             markEdited();
+            requestCompletions();
             break;
 
         case KEY_DC:
@@ -173,6 +396,7 @@ void Editor::handleKey(int ch) {
 
         case KEY_RESIZE:
             clear();
+            renderer_.invalidate();
             break;
 
         default:
@@ -180,39 +404,93 @@ void Editor::handleKey(int ch) {
                 if (doc_.hasSelection()) doc_.deleteSelection();
                 doc_.typeChar(static_cast<char>(ch));
                 markEdited();
+                requestCompletions();
             }
             break;
     }
 }
 
 bool Editor::processEvents() {
-    auto drained = events_.drainAll();
-    for (auto& ev : drained) {
-        std::visit([this](auto&& e) { this->onEvent(e); }, ev);
-    }
-    return !drained.empty();
+    size_t handled = events_.drain([this](Event& ev) { std::visit([this](auto&& e) { this->onEvent(e); }, ev); });
+    return handled > 0;
 }
 
 void Editor::onEvent(const DictionaryLoadedEvent& e) {
-    statusMessage_ = "Dictionary loaded: " + std::to_string(e.wordCount) + " words.";
-    scanPending_ = true; // now that the dictionary is ready, scan what's loaded so far
+    // The word count is already on the status bar; say how it was loaded.
+    char msg[64];
+    std::snprintf(msg, sizeof msg, "Dict %s: %zu KiB, %.2f ms.", dictionary_.mapped() ? "mapped" : "parsed",
+                  dictionary_.bytesUsed() / 1024, e.loadMs);
+    statusMessage_ = msg;
+    // Now that the dictionary is ready, scan what's loaded so far.
+    unscannedRows_.add({0, doc_.buffer().lineCount()});
+    scanPending_ = true;
 }
 
 void Editor::onEvent(const SpellScanEvent& e) {
-    if (e.version != docVersion_.load()) return; // stale - buffer changed since this scan started
-    misspellings_ = e.spans;
+    // Cancelled after it finished: a newer scan already covers these rows.
+    if (e.id != activeScan_) return;
+    activeScan_ = 0;
+    scanStats_.completed++;
+
+    // Replay the edits made since the scan's snapshot: rows they replaced
+    // drop out of the result (they are unscanned again and will be picked
+    // up by the next scan), every other row shifts to where it is now.
+    std::vector<LineRange> rows = e.rows;
+    MisspellingIndex fresh(e.spans);
+    for (const LineChange& change : changeLog_) {
+        rows = remapRanges(rows, change);
+        fresh.applyLineChange(change);
+    }
+    changeLog_.clear();
+    misspellings_.replaceRows(rows, fresh);
+    for (const LineRange& r : rows) unscannedRows_.remove(r);
+    // In a large file, what scrolled out of the window is forgotten (and
+    // rescanned if it comes back), so the spans never add up to O(document).
+    if (largeFile()) {
+        LineRange window = scanWindow();
+        std::vector<LineRange> outside{{0, window.begin}, {window.end, doc_.buffer().lineCount()}};
+        misspellings_.replaceRows(outside, MisspellingIndex());
+        for (const LineRange& r : outside) unscannedRows_.add(r);
+    }
+    speculateSuggestions();
 }
 
 void Editor::onEvent(const SuggestEvent& e) {
+    // A complete index answer is worth keeping even if nobody waits for it.
+    if (e.cacheable) suggestionCache_.put(e.result);
     if (e.version != suggestVersion_) return; // stale - superseded by a newer request
-    lastSuggestions_ = e.result;
+    lastSuggestions_ = e.cacheable ? SuggestionCache::restyle(e.result, e.typed) : e.result;
+}
+
+void Editor::onEvent(const CompletionEvent& e) {
+    if (e.version != completeVersion_) return; // stale - typed past, moved, or dismissed
+    completions_ = {e.at, e.candidates, 0};
+}
+
+void Editor::onEvent(const BufferWordsEvent& e) {
+    bufferWords_ = e.words;
+}
+
+// The first scan usually finishes before the index does; catch up on it.
+void Editor::onEvent(const SuggestionIndexReadyEvent&) {
+    speculateSuggestions();
+}
+
+void Editor::onEvent(const SpeculativeSuggestionsEvent& e) {
+    for (const SuggestionResult& r : e.results) {
+        speculating_.erase(r.word);
+        suggestionCache_.put(r);
+    }
 }
 
 void Editor::onEvent(const SaveCompleteEvent& e) {
     if (e.success) {
-        statusMessage_ = "Saved to '" + e.path + "'.";
+        char rate[64];
+        std::snprintf(rate, sizeof rate, " (%.1f MB, %.1f MB/s).", e.bytes / 1e6, e.megabytesPerSecond);
+        statusMessage_ = "Saved to '" + e.path + "'" + rate;
         doc_.setFilename(e.path);
         doc_.markClean();
+        changedOnDisk_ = false;
     } else {
         statusMessage_ = e.error;
     }
@@ -220,89 +498,192 @@ void Editor::onEvent(const SaveCompleteEvent& e) {
 
 void Editor::onEvent(const LoadCompleteEvent& e) {
     if (e.success) {
-        doc_.loadLines(e.lines);
+        if (e.load < streamingLoad_) return; // a later load got here first
+        streamingLoad_ = e.load;
+        loadedBytes_ = e.text.size;
+        loadTotalBytes_ = e.total;
+        dismissCompletions();
+        doc_.loadText(e.text, e.total >= kLargeFileBytes ? StorageKind::LargeFile : StorageKind::PieceTable);
         doc_.setFilename(e.path);
         doc_.setTrailingNewline(e.trailingNewline);
+        mapping_ = e.mapping;
+        changedOnDisk_ = false;
         view_.topLine = 0;
-        statusMessage_ = "Loaded '" + e.path + "'.";
+        if (largeFile()) bufferWords_.reset();
+        statusMessage_ = (loadingFile() ? "Loading '" : "Loaded '") + e.path + "'" +
+                         (largeFile() ? " (large file)." : ".");
         markEdited();
-        misspellings_.clear();
     } else {
         statusMessage_ = e.error;
     }
 }
 
+void Editor::onEvent(const LoadChunkEvent& e) {
+    if (e.load != streamingLoad_) return;
+    doc_.appendText(e.text);
+    loadedBytes_ = e.loaded;
+    if (!loadingFile()) statusMessage_ = "Loaded '" + doc_.filename() + "'" + (largeFile() ? " (large file)." : ".");
+    markEdited();
+}
+
 void Editor::maybeTriggerScan() {
+    // A large file is only checked around the viewport, so scrolling to
+    // rows that haven't been is reason enough to scan.
+    if (largeFile()) {
+        ensureCursorVisible(doc_, view_, viewportRows());
+        if (view_.topLine != scanWindowTop_) {
+            scanWindowTop_ = view_.topLine;
+            scanPending_ = true;
+        }
+    }
     if (!scanPending_ || !dictReady_) return;
     auto now = std::chrono::steady_clock::now();
-    if (now - lastEditTime_ < 150ms) return; // debounce: wait for a pause in typing
+    if (now - lastEditTime_ < kScanDebounce) return; // debounce: wait for a pause in typing
     scanPending_ = false;
 
-    int version = docVersion_.load();
-    BufferSnapshot snapshot = makeSnapshot(doc_.buffer().lines());
-    pool_.submit([this, version, snapshot] {
-        std::atomic<bool> neverCancel{false}; // scan staleness is handled by version, not cancellation
-        auto spans = scanBuffer(*snapshot, dictionary_, neverCancel);
-        events_.push(SpellScanEvent{version, std::move(spans)});
-        return 0;
-    });
+    // Only the rows edits have touched since their last scan - O(edited
+    // lines) per pause in typing, not O(document).
+    std::vector<LineRange> rows;
+    LineRange window = scanWindow();
+    for (LineRange r : unscannedRows_.ranges()) {
+        if (largeFile()) r = {std::max(r.begin, window.begin), std::min(r.end, window.end)};
+        if (r.begin < r.end) rows.push_back(r);
+    }
+    if (rows.empty()) return;
+
+    // The previous scan's rows are all still in unscannedRows_, so this one
+    // covers them; let it stop instead of holding a worker to the end.
+    cancelPendingScan();
+    auto myFlag = std::make_shared<std::atomic<bool>>(false);
+    scanCancelFlag_ = myFlag;
+    int id = activeScan_ = ++scanSeq_;
+    scanStats_.started++;
+
+    BufferSnapshot snapshot = makeSnapshot(doc_.buffer());
+    // The words completion draws on, recounted from the same snapshot -
+    // except in a large file, where they would be O(document).
+    if (!largeFile()) {
+        pool_.post(Lane::Background, [this, snapshot, myFlag] {
+            auto words = std::make_shared<const BufferWords>(BufferWords::collect(*snapshot, *myFlag));
+            if (!*myFlag) events_.push(BufferWordsEvent{std::move(words)});
+        });
+    }
+    // Chunked across every bulk worker; the last chunk to finish posts the
+    // merged result.
+    scanRowsParallel(pool_, Lane::Background, snapshot, dictionary_, rows, myFlag,
+                     [this, id, rows, myFlag](std::vector<MisspelledSpan> spans) {
+                         if (!*myFlag) events_.push(SpellScanEvent{id, rows, std::move(spans)});
+                     });
+}
+
+// The file the document was loaded from was written in place by another
+// program, so text the user hasn't edited may already read differently. A
+// document without edits is simply loaded again; one with edits keeps them,
+// but autosave stops rather than write the changed text back unasked.
+void Editor::checkMappedFile() {
+    if (!mapping_ || !mapping_->changedOnDisk()) return;
+    mapping_.reset(); // act once per change
+    if (!doc_.dirty()) {
+        statusMessage_ = "'" + doc_.filename() + "' changed on disk; reloading.";
+        startLoad(doc_.filename());
+        return;
+    }
+    changedOnDisk_ = true;
+    statusMessage_ = "'" + doc_.filename() + "' changed on disk; autosave is off until you save or reload.";
 }
 
 void Editor::maybeAutosave() {
-    if (!doc_.dirty() || !doc_.hasFilename()) return;
+    if (!doc_.dirty() || !doc_.hasFilename() || changedOnDisk_) return;
     auto now = std::chrono::steady_clock::now();
-    if (now - lastEditTime_ < 3s) return;  // wait for a pause in typing
-    if (now - lastAutosave_ < 5s) return;  // don't spam saves
+    if (now - lastEditTime_ < kAutosaveIdle) return;      // wait for a pause in typing
+    if (now - lastAutosave_ < kAutosaveInterval) return;  // don't spam saves
     lastAutosave_ = now;
 
     std::string path = doc_.filename();
     bool trailingNewline = doc_.trailingNewline();
-    BufferSnapshot snapshot = makeSnapshot(doc_.buffer().lines());
-    pool_.submit([this, path, snapshot, trailingNewline] {
+    BufferSnapshot snapshot = makeSnapshot(doc_.buffer());
+    pool_.post(Lane::IO, [this, path, snapshot, trailingNewline] {
         SaveResult r = saveFile(path, *snapshot, trailingNewline);
-        events_.push(SaveCompleteEvent{r.success, path, r.error});
-        return 0;
+        events_.push(SaveCompleteEvent{r.success, path, r.error, r.bytes, r.megabytesPerSecond()});
     });
 }
 
 void Editor::draw() {
     ensureCursorVisible(doc_, view_, viewportRows());
+    renderer_.beginFrame(LINES);
 
-    move(0, 0);
-    clrtoeol();
-    printw("ESC quit | ^L load ^R save ^D save-as | ^A select ^K copy ^X cut ^V paste | ^Z undo ^Y redo | ^F find ^E replace | ^W suggest");
+    renderer_.drawTextRow(0, "ESC quit | ^L load ^R save ^D save-as | ^A select ^K copy ^X cut ^V paste | "
+                             "^Z undo ^Y redo | ^F find ^E replace | ^W suggest", A_NORMAL);
 
-    drawStatusBar(1, COLS, doc_, dictReady_, dictionary_.size(), statusMessage_);
+    int loadPercent = loadingFile() ? static_cast<int>(loadedBytes_ * 100 / loadTotalBytes_) : -1;
+    renderer_.drawTextRow(
+        1, formatStatusBar(doc_, dictReady_, dictReady_ ? dictionary_.size() : 0, statusMessage_, loadPercent),
+        COLOR_PAIR(PAIR_STATUS));
 
-    move(2, 0);
-    clrtoeol();
+    std::string suggestionLine;
     if (!lastSuggestions_.word.empty()) {
         if (lastSuggestions_.correct) {
-            printw("'%s' is spelled correctly.", lastSuggestions_.word.c_str());
+            suggestionLine = "'" + lastSuggestions_.word + "' is spelled correctly.";
         } else {
-            printw("Suggestions for '%s': ", lastSuggestions_.word.c_str());
-            for (auto& s : lastSuggestions_.suggestions) printw("%s ", s.c_str());
-            if (lastSuggestions_.suggestions.empty()) printw("(none found)");
+            suggestionLine = "Suggestions for '" + lastSuggestions_.word + "': ";
+            for (auto& s : lastSuggestions_.suggestions) suggestionLine += s + " ";
+            if (lastSuggestions_.suggestions.empty()) suggestionLine += "(none found)";
         }
     }
+    // The counters take the otherwise idle suggestions row.
+    if (suggestionLine.empty() && showStats_) {
+        long long lookups = suggestionCache_.hits() + suggestionCache_.misses();
+        suggestionLine = "painted " + std::to_string(lastFramePainted_) + "/" + std::to_string(LINES) + " rows, " +
+                         std::to_string(lastFrameCalls_) + " calls | scans " + std::to_string(scanStats_.started) +
+                         "/" + std::to_string(scanStats_.cancelled) + "/" + std::to_string(scanStats_.completed) +
+                         " | cache " + std::to_string(suggestionCache_.size()) + " words, " +
+                         std::to_string(lookups ? suggestionCache_.hits() * 100 / lookups : 0) + "% hits";
+    }
+    renderer_.drawTextRow(2, suggestionLine, A_NORMAL);
 
-    renderBuffer(doc_, view_, viewportRows(), COLS, misspellings_);
+    renderer_.drawBuffer(doc_, view_, viewportRows(), COLS, misspellings_, &completions_);
     refresh();
+    lastFramePainted_ = renderer_.stats().rowsPainted;
+    lastFrameCalls_ = renderer_.stats().cursesCalls;
 }
 
 int Editor::viewportRows() const {
     return LINES - kHeaderRows;
 }
 
+// A screenful above the viewport to a screenful below it.
+LineRange Editor::scanWindow() const {
+    Row rows = viewportRows();
+    return {std::max<Row>(0, view_.topLine - rows), view_.topLine + 2 * rows};
+}
+
+bool Editor::largeFile() const {
+    return doc_.buffer().storageKind() == StorageKind::LargeFile;
+}
+
+// Prompts draw over the header rows behind the renderer's back, so every
+// prompt is followed by a full repaint.
+std::string Editor::prompt(const std::string& label) {
+    std::string answer = promptInput(0, label);
+    renderer_.invalidate();
+    return answer;
+}
+
+bool Editor::confirm(const std::string& question) {
+    bool answer = promptYesNo(0, question);
+    renderer_.invalidate();
+    return answer;
+}
+
 bool Editor::confirmQuitIfDirty() {
     if (!doc_.dirty()) return true;
-    return promptYesNo(0, "Unsaved changes. Quit anyway?");
+    return confirm("Unsaved changes. Quit anyway?");
 }
 
 void Editor::doSave(bool saveAs) {
     std::string path = doc_.filename();
     if (saveAs || !doc_.hasFilename()) {
-        std::string entered = promptInput(0, "Save as: ");
+        std::string entered = prompt("Save as: ");
         if (entered.empty()) {
             statusMessage_ = "Save cancelled.";
             return;
@@ -312,41 +693,47 @@ void Editor::doSave(bool saveAs) {
 
     statusMessage_ = "Saving...";
     bool trailingNewline = doc_.trailingNewline();
-    BufferSnapshot snapshot = makeSnapshot(doc_.buffer().lines());
-    pool_.submit([this, path, snapshot, trailingNewline] {
+    BufferSnapshot snapshot = makeSnapshot(doc_.buffer());
+    pool_.post(Lane::IO, [this, path, snapshot, trailingNewline] {
         SaveResult r = saveFile(path, *snapshot, trailingNewline);
-        events_.push(SaveCompleteEvent{r.success, path, r.error});
-        return 0;
+        events_.push(SaveCompleteEvent{r.success, path, r.error, r.bytes, r.megabytesPerSecond()});
     });
 }
 
 void Editor::doLoad() {
-    std::string entered = promptInput(0, "Load file: ");
+    std::string entered = prompt("Load file: ");
     if (entered.empty()) {
         statusMessage_ = "Load cancelled.";
         return;
     }
 
-    std::string path = entered;
     statusMessage_ = "Loading...";
-    pool_.submit([this, path] {
-        LoadResult r = loadFile(path);
-        events_.push(LoadCompleteEvent{r.success, r.lines, path, r.error, r.trailingNewline});
-        return 0;
-    });
+    startLoad(entered);
+}
+
+void Editor::startLoad(const std::string& path) {
+    int load = ++loadSeq_;
+    streamFileParallel(
+        pool_, Lane::IO, path,
+        [this, path, load](LoadResult r, size_t total) {
+            events_.push(
+                LoadCompleteEvent{r.success, std::move(r.text), path, r.error, r.trailingNewline, load, total,
+                                  std::move(r.mapping)});
+        },
+        [this, load](LoadChunk c) { events_.push(LoadChunkEvent{load, std::move(c.text), c.loaded, c.total}); });
 }
 
 void Editor::doFind() {
-    std::string needle = promptInput(0, "Find: ");
+    std::string needle = prompt("Find: ");
     if (needle.empty()) return;
     lastSearch_ = needle;
     statusMessage_ = doc_.findNext(needle, false) ? "Found." : ("'" + needle + "' not found.");
 }
 
 void Editor::doReplace() {
-    std::string needle = promptInput(0, "Replace - find: ");
+    std::string needle = prompt("Replace - find: ");
     if (needle.empty()) return;
-    std::string replacement = promptInput(0, "Replace with: ");
+    std::string replacement = prompt("Replace with: ");
 
     int count = doc_.replaceAll(needle, replacement, false);
     statusMessage_ = std::to_string(count) + " replacement(s).";
@@ -1,20 +1,38 @@
 #pragma once
+#include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <memory>
+#include <optional>
 #include <string>
+#include <thread>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include "concurrent/EventQueue.h"
 #include "concurrent/ThreadPool.h"
 #include "core/Clipboard.h"
 #include "core/Document.h"
+#include "spell/Completer.h"
+#include "spell/Dawg.h"
+#include "spell/DeletionIndex.h"
 #include "spell/Dictionary.h"
+#include "spell/MisspellingIndex.h"
 #include "spell/Suggester.h"
+#include "spell/SuggestionCache.h"
+#include "spell/WordFrequencies.h"
 #include "ui/Renderer.h"
 #include "ui/Screen.h"
 
 namespace editor {
 
+struct ScanStats {
+    long long started = 0;
+    long long cancelled = 0; // superseded by a newer scan before being applied
+    long long completed = 0;
+};
+
 class Editor {
 public:
     explicit Editor(std::string initialFile);
@@ -31,46 +49,119 @@ private:
     Screen screen_;
     EventQueue events_;
     Dictionary dictionary_;
+    Dawg dawg_;
+    DeletionIndex deletions_;
+    Completer completer_;
+    WordFrequencies frequencies_;
     Document doc_;
     Clipboard clipboard_;
     ViewState view_;
+    Renderer renderer_;
 
     std::atomic<bool> dictReady_{false};
-    std::atomic<int> docVersion_{0};
+    std::atomic<bool> dawgReady_{false};
+    std::atomic<bool> indexReady_{false};
+    std::atomic<bool> completerReady_{false};
     bool scanPending_ = false;
-    std::vector<MisspelledSpan> misspellings_;
+    MisspellingIndex misspellings_;
+    LineRangeSet unscannedRows_;               // rows whose spans are out of date
+    // The one scan whose result will be applied; starting a scan cancels
+    // the previous one (its rows are still unscanned, so the new scan
+    // covers them). 0 = none in flight.
+    int activeScan_ = 0;
+    int scanSeq_ = 0;
+    std::shared_ptr<std::atomic<bool>> scanCancelFlag_;
+    // Line changes made since the active scan's snapshot, so its result can
+    // be shifted onto the current rows instead of being thrown away.
+    std::vector<LineChange> changeLog_;
+    ScanStats scanStats_;
     SuggestionResult lastSuggestions_;
     int suggestVersion_ = 0;
     std::shared_ptr<std::atomic<bool>> suggestCancelFlag_;
+    // Answers Ctrl+W without a round trip to a worker. Filled on demand and,
+    // after each scan, speculatively for the misspellings around the
+    // viewport; `speculating_` holds the words a worker is already on.
+    SuggestionCache suggestionCache_;
+    std::unordered_set<std::string> speculating_;
+    std::shared_ptr<std::atomic<bool>> speculateCancelFlag_ = std::make_shared<std::atomic<bool>>(false);
+    // The completion popup. Every key bumps completeVersion_, so a result
+    // computed for text the user has typed past is dropped on arrival.
+    Popup completions_;
+    int completeVersion_ = 0;
+    std::shared_ptr<const BufferWords> bufferWords_;
+    // File loads stream in: the document shows the first chunk at once and
+    // grows as LoadChunkEvents arrive. Each load is numbered; only chunks
+    // of the one the document came from (streamingLoad_) are applied, and
+    // until all of it is in the buffer is read-only.
+    int loadSeq_ = 0;
+    int streamingLoad_ = 0;
+    size_t loadedBytes_ = 0;
+    size_t loadTotalBytes_ = 0;
+    // In large-file mode only rows in scanWindow() are spell checked; this
+    // is the top line the window was last worked out for.
+    Row scanWindowTop_ = -1;
+    // The mapping the document's untouched text reads from, checked for
+    // in-place changes by other programs (see MappedFile). Autosave stops
+    // once one is seen on a document with edits, until it is saved or
+    // reloaded.
+    std::shared_ptr<const MappedFile> mapping_;
+    bool changedOnDisk_ = false;
 
     std::string initialFile_;
     std::string statusMessage_;
     std::string lastSearch_;
     bool running_ = true;
+    bool showStats_ = false; // TEXTEDITOR_STATS set: show render counters in the status bar
+    int lastFramePainted_ = 0;
+    long long lastFrameCalls_ = 0;
 
     std::chrono::steady_clock::time_point lastEditTime_;
     std::chrono::steady_clock::time_point lastAutosave_;
 
-    ThreadPool pool_;
+    // One worker per core for bulk work (scans, I/O) plus one that bulk
+    // work may never occupy, so suggestions always find a free worker.
+    ThreadPool pool_{std::max(2u, std::thread::hardware_concurrency()) + 1};
 
     void handleKey(int ch);
+    void waitForActivity();
+    std::optional<std::chrono::steady_clock::time_point> nextDeadline() const;
     bool processEvents();
     void onEvent(const DictionaryLoadedEvent&);
     void onEvent(const SpellScanEvent&);
     void onEvent(const SuggestEvent&);
+    void onEvent(const SuggestionIndexReadyEvent&);
+    void onEvent(const SpeculativeSuggestionsEvent&);
+    void onEvent(const CompletionEvent&);
+    void onEvent(const BufferWordsEvent&);
     void onEvent(const SaveCompleteEvent&);
     void onEvent(const LoadCompleteEvent&);
+    void onEvent(const LoadChunkEvent&);
 
     void markEdited();
+    void trackLineChanges();
     void cancelPendingSuggestion();
+    void cancelPendingScan();
     void requestSuggestions();
+    void speculateSuggestions();
+    void requestCompletions();
+    void acceptCompletion();
+    void dismissCompletions();
     void maybeTriggerScan();
     void maybeAutosave();
+    void checkMappedFile();
     void draw();
     int viewportRows() const;
+    LineRange scanWindow() const;
+    bool largeFile() const;
+    std::string prompt(const std::string& label);
+    bool confirm(const std::string& question);
     bool confirmQuitIfDirty();
     void doSave(bool saveAs);
     void doLoad();
+    // Opens `path` on the IO lane and streams it in: a LoadCompleteEvent
+    // with its start, then LoadChunkEvents as the pool indexes the rest.
+    void startLoad(const std::string& path);
+    bool loadingFile() const { return loadedBytes_ < loadTotalBytes_; }
     void doFind();
     void doReplace();
 };
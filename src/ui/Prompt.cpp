@@ -5,10 +5,11 @@
 
 namespace editor {
 
-// The main loop runs getch() with a 16ms timeout so it can poll worker
-// events between keystrokes. A modal prompt has nothing else to do while
-// waiting, so it switches to blocking reads for its duration and restores
-// the poll timeout on the way out.
+// The main loop reads keys non-blocking, after poll() has said input is
+// waiting. A modal prompt has nothing else to do while waiting, so it
+// switches to blocking reads for its duration and restores non-blocking
+// mode on the way out. Worker events that arrive meanwhile stay queued
+// (and the queue's wakeup fd stays readable) until the prompt returns.
 
 std::string promptInput(int row, const std::string& label, size_t maxLen) {
     nodelay(stdscr, FALSE);
@@ -22,7 +23,7 @@ std::string promptInput(int row, const std::string& label, size_t maxLen) {
     getnstr(buf.data(), static_cast<int>(maxLen));
 
     noecho();
-    timeout(16);
+    nodelay(stdscr, TRUE);
     return std::string(buf.data());
 }
 
@@ -38,7 +39,7 @@ bool promptYesNo(int row, const std::string& question) {
         ch = getch();
     } while (ch != 'y' && ch != 'Y' && ch != 'n' && ch != 'N' && ch != 27);
 
-    timeout(16);
+    nodelay(stdscr, TRUE);
     return ch == 'y' || ch == 'Y';
 }
 
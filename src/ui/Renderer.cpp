@@ -2,12 +2,40 @@
 
 #include <algorithm>
 #include <ncurses.h>
+#include <string_view>
 
 #include "core/Document.h"
 #include "ui/Screen.h"
 
 namespace editor {
 
+namespace {
+// 64-bit FNV-1a, fed field by field.
+struct RowHash {
+    uint64_t value = 1469598103934665603ull;
+
+    void add(const char* data, size_t len) {
+        for (size_t i = 0; i < len; ++i) {
+            value ^= static_cast<unsigned char>(data[i]);
+            value *= 1099511628211ull;
+        }
+    }
+    void add(int v) { add(reinterpret_cast<const char*>(&v), sizeof v); }
+
+    // 0 is reserved for "unknown".
+    uint64_t finish() const { return value == 0 ? 1 : value; }
+};
+
+int attrsFor(CellStyle style) {
+    switch (style) {
+        case CellStyle::Selected: return COLOR_PAIR(PAIR_SELECTION) | A_REVERSE;
+        case CellStyle::Misspelled: return COLOR_PAIR(PAIR_MISSPELLED) | A_UNDERLINE;
+        case CellStyle::Normal: break;
+    }
+    return A_NORMAL;
+}
+} // namespace
+
 void ensureCursorVisible(const Document& doc, ViewState& view, int viewportRows) {
     Position cur = doc.buffer().cursor();
     if (cur.row < view.topLine) view.topLine = cur.row;
@@ -15,10 +43,46 @@ void ensureCursorVisible(const Document& doc, ViewState& view, int viewportRows)
     if (view.topLine < 0) view.topLine = 0;
 }
 
-void renderBuffer(const Document& doc, ViewState& view, int viewportRows, int viewportCols,
-                   const std::vector<MisspelledSpan>& misspellings) {
-    const auto& lines = doc.buffer().lines();
-    Position cur = doc.buffer().cursor();
+void Renderer::invalidate() {
+    std::fill(shown_.begin(), shown_.end(), 0);
+}
+
+void Renderer::beginFrame(int screenRows) {
+    if (static_cast<int>(shown_.size()) != screenRows) shown_.assign(std::max(screenRows, 0), 0);
+    stats_.frames++;
+    stats_.rowsPainted = 0;
+    stats_.rowsTotal = screenRows;
+    stats_.cursesCalls = 0;
+}
+
+bool Renderer::needsPaint(int row, uint64_t hash) {
+    if (row < 0 || row >= static_cast<int>(shown_.size())) return false;
+    if (shown_[row] == hash) return false;
+    shown_[row] = hash;
+    stats_.rowsPainted++;
+    stats_.totalRowsPainted++;
+    return true;
+}
+
+void Renderer::drawTextRow(int row, const std::string& text, int attrs) {
+    int len = std::min(static_cast<int>(text.size()), COLS);
+    RowHash h;
+    h.add(text.data(), len);
+    h.add(attrs);
+    if (!needsPaint(row, h.finish())) return;
+
+    move(row, 0);
+    attrset(attrs);
+    addnstr(text.c_str(), len);
+    attrset(A_NORMAL);
+    if (len < COLS) clrtoeol();
+    stats_.cursesCalls += 5; // move, attrset x2, addnstr, clrtoeol
+}
+
+void Renderer::drawBuffer(const Document& doc, const ViewState& view, int viewportRows, int viewportCols,
+                          const MisspellingIndex& misspellings, const Popup* popup) {
+    const TextBuffer& buf = doc.buffer();
+    Position cur = buf.cursor();
 
     bool hasSel = doc.hasSelection();
     Position selA{}, selB{};
@@ -28,36 +92,86 @@ void renderBuffer(const Document& doc, ViewState& view, int viewportRows, int vi
         selB = range.second;
     }
 
+    // Only the spans on visible rows, in (row, col) order; `span` walks
+    // forward through them as rows and columns advance.
+    auto [span, spansEnd] = misspellings.rows(view.topLine, view.topLine + viewportRows);
+
+    // Where the popup goes: screen rows [popupTop, popupTop + items), every
+    // item padded to the widest so it reads as one box.
+    int popupTop = 0, popupRows = 0, popupCol = 0, popupWidth = 0;
+    if (popup && !popup->items.empty()) {
+        int anchor = static_cast<int>(popup->at.row - view.topLine); // on screen, so small
+        popupRows = std::min(static_cast<int>(popup->items.size()), std::max(anchor, viewportRows - anchor - 1));
+        popupTop = anchor + 1 + popupRows <= viewportRows ? anchor + 1 : anchor - popupRows;
+        for (const std::string& item : popup->items) popupWidth = std::max(popupWidth, static_cast<int>(item.size()) + 2);
+        popupWidth = std::min(popupWidth, viewportCols);
+        popupCol = std::clamp(popup->at.col, 0, std::max(0, viewportCols - popupWidth));
+    }
+
+    // The visible rows in one walk of the storage; looking each one up
+    // would walk a large file's piece once per row, every frame.
+    rowText_.resize(static_cast<size_t>(std::max(viewportRows, 0)));
+    for (std::string& text : rowText_) text.clear();
+    buf.forEachLine(view.topLine, view.topLine + viewportRows, [this, &view](Row row, std::string_view text) {
+        rowText_[static_cast<size_t>(row - view.topLine)].assign(text);
+    });
+
     for (int screenRow = 0; screenRow < viewportRows; ++screenRow) {
-        int docRow = view.topLine + screenRow;
-        move(kHeaderRows + screenRow, 0);
-        clrtoeol();
-        if (docRow >= static_cast<int>(lines.size())) continue;
-
-        const std::string& line = lines[docRow];
-        std::vector<bool> bad(line.size(), false);
-        for (const auto& span : misspellings) {
-            if (span.row != docRow) continue;
-            for (int c = span.colStart; c < span.colEnd && c < static_cast<int>(bad.size()); ++c) bad[c] = true;
+        Row docRow = view.topLine + screenRow;
+        const std::string& line = rowText_[static_cast<size_t>(screenRow)];
+        while (span != spansEnd && span->row < docRow) ++span;
+        int maxCol = std::min(static_cast<int>(line.size()), viewportCols);
+
+        // Everything that decides how this row looks: visible text, the
+        // selected columns on it, and its misspelled spans.
+        int selStart = 0, selEnd = 0;
+        if (hasSel && docRow >= selA.row && docRow <= selB.row) {
+            selStart = docRow == selA.row ? selA.col : 0;
+            selEnd = docRow == selB.row ? selB.col : maxCol;
+        }
+        RowHash h;
+        h.add(line.data(), maxCol);
+        h.add(std::clamp(selStart, 0, maxCol));
+        h.add(std::clamp(selEnd, 0, maxCol));
+        for (auto s = span; s != spansEnd && s->row == docRow && s->colStart < maxCol; ++s) {
+            h.add(s->colStart);
+            h.add(s->colEnd);
+        }
+        int item = screenRow - popupTop;
+        bool underPopup = popupRows > 0 && item >= 0 && item < popupRows;
+        std::string cell;
+        if (underPopup) {
+            cell = " " + popup->items[item];
+            cell.resize(popupWidth, ' ');
+            h.add(cell.data(), cell.size());
+            h.add(popupCol);
+            h.add(item == popup->selected);
         }
+        if (!needsPaint(kHeaderRows + screenRow, h.finish())) continue;
 
-        int maxCol = std::min(static_cast<int>(line.size()), viewportCols);
-        for (int col = 0; col < maxCol; ++col) {
-            bool selected = hasSel &&
-                (docRow > selA.row || (docRow == selA.row && col >= selA.col)) &&
-                (docRow < selB.row || (docRow == selB.row && col < selB.col));
-
-            int attrs = A_NORMAL;
-            if (selected) attrs = COLOR_PAIR(PAIR_SELECTION) | A_REVERSE;
-            else if (bad[col]) attrs = COLOR_PAIR(PAIR_MISSPELLED) | A_UNDERLINE;
-
-            attron(attrs);
-            mvaddch(kHeaderRows + screenRow, col, line[col]);
-            attroff(attrs);
+        // One attribute change and one string write per run of same-styled
+        // cells, rather than attron/mvaddch/attroff per character.
+        buildRuns(docRow, maxCol, selStart, selEnd, span, spansEnd, runs_);
+        move(kHeaderRows + screenRow, 0);
+        for (const StyleRun& run : runs_) {
+            attrset(attrsFor(run.style));
+            addnstr(line.data() + run.colStart, run.colEnd - run.colStart);
+        }
+        attrset(A_NORMAL);
+        // Writing the last column already wrapped the cursor to the next
+        // row; clearing from there would wipe that row.
+        if (maxCol < viewportCols) clrtoeol();
+        stats_.cursesCalls += 2 * static_cast<long long>(runs_.size()) + 3; // + move, attrset, clrtoeol
+        if (underPopup) {
+            move(kHeaderRows + screenRow, popupCol);
+            attrset(item == popup->selected ? A_REVERSE | A_BOLD : A_REVERSE);
+            addnstr(cell.data(), static_cast<int>(cell.size()));
+            attrset(A_NORMAL);
+            stats_.cursesCalls += 4;
         }
     }
 
-    int screenCursorRow = kHeaderRows + (cur.row - view.topLine);
+    int screenCursorRow = kHeaderRows + static_cast<int>(cur.row - view.topLine);
     int screenCursorCol = std::min(cur.col, viewportCols > 0 ? viewportCols - 1 : 0);
     move(screenCursorRow, screenCursorCol);
 }
@@ -1,14 +1,27 @@
 #pragma once
+#include <cstdint>
+#include <string>
 #include <vector>
 
-#include "spell/SpellChecker.h"
+#include "core/Position.h"
+#include "spell/MisspellingIndex.h"
+#include "ui/RowRuns.h"
 
 namespace editor {
 
 class Document;
 
 struct ViewState {
-    int topLine = 0;
+    Row topLine = 0;
+};
+
+// A short list drawn over the text, left-aligned with `at` on the rows
+// below it (above it when there isn't room), e.g. completions for the word
+// being typed. `selected` is highlighted.
+struct Popup {
+    Position at;
+    std::vector<std::string> items;
+    int selected = 0;
 };
 
 // Header rows reserved above the text area: key hints, status bar, and a
@@ -16,14 +29,52 @@ struct ViewState {
 constexpr int kHeaderRows = 3;
 
 // Scrolls `view` so the cursor stays within the visible viewport. Call
-// before renderBuffer() whenever the cursor may have moved.
+// before Renderer::drawBuffer() whenever the cursor may have moved.
 void ensureCursorVisible(const Document& doc, ViewState& view, int viewportRows);
 
-// Draws only the visible slice of the buffer [topLine, topLine+viewportRows)
-// and positions the terminal cursor from the document's actual cursor state
-// - unlike the original's printTextContent(), which recomputed screen
-// position by walking the whole buffer and lost track of the real cursor.
-void renderBuffer(const Document& doc, ViewState& view, int viewportRows, int viewportCols,
-                   const std::vector<MisspelledSpan>& misspellings);
+struct RenderStats {
+    int rowsPainted = 0; // screen rows repainted by the last frame
+    int rowsTotal = 0;   // screen rows the last frame covered
+    long long cursesCalls = 0; // drawing calls issued by the last frame
+    long long frames = 0;
+    long long totalRowsPainted = 0;
+};
+
+// Damage-tracking screen writer. For every screen row it remembers a hash of
+// what that row last showed (text, attributes, selection) and repaints a row
+// only when the hash changes, so an idle redraw or a keystroke that touches
+// one line costs one row of curses calls rather than a whole screen.
+//
+// Anything that draws behind the renderer's back (a resize, a prompt) must
+// call invalidate() so the next frame repaints everything.
+class Renderer {
+public:
+    void invalidate();
+
+    // Starts a frame covering `screenRows` rows.
+    void beginFrame(int screenRows);
+
+    // Draws `text` (truncated to the screen width) on `row` with `attrs`.
+    void drawTextRow(int row, const std::string& text, int attrs);
+
+    // Draws only the visible slice of the buffer [topLine, topLine+viewportRows)
+    // and positions the terminal cursor from the document's actual cursor state
+    // - unlike the original's printTextContent(), which recomputed screen
+    // position by walking the whole buffer and lost track of the real cursor.
+    // A `popup` is painted over the rows it covers and is part of their
+    // damage hash, so it appears and disappears like any other change.
+    void drawBuffer(const Document& doc, const ViewState& view, int viewportRows, int viewportCols,
+                    const MisspellingIndex& misspellings, const Popup* popup = nullptr);
+
+    const RenderStats& stats() const { return stats_; }
+
+private:
+    std::vector<uint64_t> shown_; // per screen row; 0 = unknown, always repaint
+    std::vector<StyleRun> runs_;  // scratch, reused across rows and frames
+    std::vector<std::string> rowText_; // the visible rows, read in one walk per frame
+    RenderStats stats_;
+
+    bool needsPaint(int row, uint64_t hash);
+};
 
 } // namespace editor
@@ -0,0 +1,36 @@
+#include "ui/RowRuns.h"
+
+#include <algorithm>
+
+namespace editor {
+
+void buildRuns(Row docRow, int maxCol, int selStart, int selEnd, MisspellingIndex::const_iterator spans,
+               MisspellingIndex::const_iterator spansEnd, std::vector<StyleRun>& out) {
+    out.clear();
+    while (spans != spansEnd && spans->row < docRow) ++spans;
+
+    int col = 0;
+    while (col < maxCol) {
+        while (spans != spansEnd && spans->row == docRow && spans->colEnd <= col) ++spans;
+        bool haveSpan = spans != spansEnd && spans->row == docRow;
+        bool inSpan = haveSpan && spans->colStart <= col;
+        bool inSel = col >= selStart && col < selEnd;
+
+        // The run ends at the next point where either input changes.
+        int end = maxCol;
+        if (inSel) end = std::min(end, selEnd);
+        else if (selStart > col && selEnd > selStart) end = std::min(end, selStart);
+        if (inSpan) end = std::min(end, spans->colEnd);
+        else if (haveSpan) end = std::min(end, spans->colStart);
+
+        CellStyle style = inSel ? CellStyle::Selected : inSpan ? CellStyle::Misspelled : CellStyle::Normal;
+        if (!out.empty() && out.back().style == style && out.back().colEnd == col) {
+            out.back().colEnd = end;
+        } else {
+            out.push_back({col, end, style});
+        }
+        col = end;
+    }
+}
+
+} // namespace editor
@@ -0,0 +1,27 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "spell/MisspellingIndex.h"
+
+namespace editor {
+
+enum class CellStyle : uint8_t { Normal, Misspelled, Selected };
+
+// Columns [colStart, colEnd) of a row that share one style.
+struct StyleRun {
+    int colStart;
+    int colEnd;
+    CellStyle style;
+};
+
+// Splits columns [0, maxCol) of `docRow` into maximal runs of identical
+// style, so the renderer can emit one attribute change and one string write
+// per run instead of three curses calls per character. Selection
+// ([selStart, selEnd)) wins over misspelling. `spans` must start at or
+// before the row's first span; spans on other rows are ignored. Kept free of
+// ncurses so it can be unit-tested and benchmarked.
+void buildRuns(Row docRow, int maxCol, int selStart, int selEnd, MisspellingIndex::const_iterator spans,
+               MisspellingIndex::const_iterator spansEnd, std::vector<StyleRun>& out);
+
+} // namespace editor
@@ -6,7 +6,10 @@ namespace editor {
 
 class Document;
 
-void drawStatusBar(int row, int cols, const Document& doc, bool dictReady, size_t dictWordCount,
-                    const std::string& message);
+// The status bar's text; Editor draws it through Renderer::drawTextRow so it
+// is only repainted when it changes. `loadPercent` is how much of a file
+// that is streaming in has arrived, or -1 when none is.
+std::string formatStatusBar(const Document& doc, bool dictReady, size_t dictWordCount, const std::string& message,
+                            int loadPercent = -1);
 
 } // namespace editor
@@ -0,0 +1,51 @@
+#include <atomic>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "core/TextSnapshot.h"
+#include "harness.h"
+#include "spell/Completer.h"
+#include "spell/WordFrequencies.h"
+
+using namespace editor;
+
+TEST(completer_ranks_by_frequency_then_length) {
+    WordFrequencies freq;
+    freq.build({{"help", 50}, {"hello", 200}, {"helicopter", 50}});
+    Completer c;
+    c.build({"hello", "help", "helicopter", "helm", "Helix", "hel", "world"}, &freq);
+    CHECK_EQ(c.size(), static_cast<size_t>(7));
+
+    auto got = c.complete("hel", 10);
+    std::vector<std::string> expected{"hello", "help", "helicopter", "helm", "helix"};
+    CHECK(got == expected); // "hel" itself is not a completion
+
+    got = c.complete("HeL", 2); // typed prefix kept as is
+    CHECK(got == (std::vector<std::string>{"HeLlo", "HeLp"}));
+
+    CHECK(c.complete("xyz", 10).empty());
+    CHECK(c.complete("", 10).empty());
+    CHECK(c.complete("hel", 0).empty());
+    CHECK(Completer().complete("hel", 10).empty());
+}
+
+TEST(completer_puts_the_documents_own_words_first) {
+    Completer c;
+    c.build({"tree", "treat", "trend", "trellis"});
+    LineVectorSnapshot doc({"The Treemap and the treemap, then a trellis.", "tr it"});
+    std::atomic<bool> cancelled{false};
+    BufferWords words = BufferWords::collect(doc, cancelled);
+    // Lowercased and counted; "it", "tr" and "a" are too short to keep.
+    CHECK(words.entries() == (std::vector<std::pair<std::string, uint32_t>>{
+                                 {"and", 1}, {"the", 2}, {"then", 1}, {"treemap", 2}, {"trellis", 1}}));
+
+    auto got = c.complete("tre", 10, &words);
+    CHECK(got == (std::vector<std::string>{"treemap", "trellis", "tree", "treat", "trend"}));
+}
+
+TEST(buffer_words_respect_cancellation) {
+    LineVectorSnapshot doc({"some words here"});
+    std::atomic<bool> cancelled{true};
+    CHECK_EQ(BufferWords::collect(doc, cancelled).size(), static_cast<size_t>(0));
+}
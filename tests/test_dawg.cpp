@@ -0,0 +1,127 @@
+#include <atomic>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "harness.h"
+#include "spell/Dawg.h"
+#include "spell/Dictionary.h"
+#include "spell/Suggester.h"
+
+using namespace editor;
+
+namespace {
+// Random lowercase words over a small alphabet, so they share plenty of
+// prefixes and suffixes and one-letter edits often land on other words.
+std::vector<std::string> randomWords(size_t count, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::vector<std::string> words;
+    for (size_t i = 0; i < count; ++i) {
+        std::string w(2 + rng() % 6, 'a');
+        for (char& c : w) c = static_cast<char>('a' + rng() % 6);
+        words.push_back(w);
+    }
+    return words;
+}
+} // namespace
+
+TEST(dawg_contains_folds_case_and_rejects_prefixes) {
+    Dawg dawg;
+    dawg.build({"Hello", "help", "helper", "world", "hello"});
+    CHECK_EQ(dawg.size(), static_cast<size_t>(4));
+    CHECK(dawg.contains("hello"));
+    CHECK(dawg.contains("HELPER"));
+    CHECK(dawg.contains("World"));
+    CHECK(!dawg.contains("hel"));
+    CHECK(!dawg.contains("helpers"));
+    CHECK(!dawg.contains(""));
+    CHECK(!Dawg().contains("hello"));
+}
+
+TEST(dawg_answers_prefix_queries) {
+    Dawg dawg;
+    dawg.build({"car", "cart", "carton", "cat", "dog"});
+    CHECK(dawg.hasPrefix("ca"));
+    CHECK(dawg.hasPrefix("CART"));
+    CHECK(dawg.hasPrefix(""));
+    CHECK(!dawg.hasPrefix("cb"));
+    CHECK(!dawg.hasPrefix("cartons"));
+    CHECK(!Dawg().hasPrefix(""));
+
+    std::vector<std::string> car = dawg.wordsWithPrefix("Car");
+    CHECK_EQ(car.size(), static_cast<size_t>(3));
+    CHECK_EQ(car[0], std::string("car"));
+    CHECK_EQ(car[1], std::string("cart"));
+    CHECK_EQ(car[2], std::string("carton"));
+    CHECK_EQ(dawg.wordsWithPrefix("c", 2).size(), static_cast<size_t>(2));
+    CHECK_EQ(dawg.wordsWithPrefix("", 100).size(), static_cast<size_t>(5));
+    CHECK(dawg.wordsWithPrefix("x").empty());
+    CHECK(dawg.wordsWithPrefix("car", 0).empty());
+}
+
+TEST(dawg_shares_common_suffixes) {
+    // As a plain trie this is 2 x (4 + 1 + 3) = 16 edges; minimized, the
+    // "-ing"/"-s" tails are stored once.
+    Dawg dawg;
+    dawg.build({"walk", "walks", "walking", "talk", "talks", "talking"});
+    CHECK_EQ(dawg.size(), static_cast<size_t>(6));
+    CHECK(dawg.edgeCount() <= 9);
+    CHECK(dawg.contains("talking"));
+    CHECK(!dawg.contains("talkings"));
+}
+
+TEST(dawg_agrees_with_the_hash_table) {
+    std::vector<std::string> words = randomWords(3000, 11);
+    Dawg dawg;
+    dawg.build(words);
+    // Dictionary has no build-from-vector; round-trip through a file.
+    {
+        std::FILE* f = std::fopen("test_dawg_tmp.txt", "w");
+        for (const std::string& w : words) std::fprintf(f, "%s\n", w.c_str());
+        std::fclose(f);
+    }
+    Dictionary dict;
+    dict.loadFromFile("test_dawg_tmp.txt");
+    std::remove("test_dawg_tmp.txt");
+
+    CHECK_EQ(dawg.size(), dict.size());
+    for (const std::string& probe : randomWords(5000, 12)) {
+        if (dawg.contains(probe) != dict.contains(probe)) {
+            CHECK(dawg.contains(probe) == dict.contains(probe));
+            break;
+        }
+    }
+}
+
+TEST(dawg_suggestions_match_brute_force) {
+    std::vector<std::string> words = randomWords(3000, 21);
+    words.push_back("world");
+    words.push_back("word");
+    Dawg dawg;
+    dawg.build(words);
+    {
+        std::FILE* f = std::fopen("test_dawg_tmp2.txt", "w");
+        for (const std::string& w : words) std::fprintf(f, "%s\n", w.c_str());
+        std::fclose(f);
+    }
+    Dictionary dict;
+    dict.loadFromFile("test_dawg_tmp2.txt");
+    std::remove("test_dawg_tmp2.txt");
+
+    std::atomic<bool> cancelled{false};
+    std::vector<std::string> probes = randomWords(400, 22);
+    probes.push_back("Wrold");
+    probes.push_back("wordl");
+    probes.push_back("x");
+    for (const std::string& probe : probes) {
+        SuggestionResult fast = suggest(dawg, probe, cancelled);
+        SuggestionResult slow = suggest(dict, probe, cancelled);
+        if (fast.correct != slow.correct || fast.suggestions != slow.suggestions) {
+            CHECK_EQ(probe, std::string("(a probe both searches agree on)"));
+            break;
+        }
+    }
+    SuggestionResult r = suggest(dawg, "Wrold", cancelled);
+    CHECK(!r.suggestions.empty());
+}
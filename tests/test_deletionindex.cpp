@@ -0,0 +1,119 @@
+#include <algorithm>
+#include <atomic>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "harness.h"
+#include "spell/DeletionIndex.h"
+#include "spell/Suggester.h"
+
+using namespace editor;
+
+namespace {
+// Reference optimal-string-alignment distance, unbounded.
+int distance(const std::string& a, const std::string& b) {
+    std::vector<std::vector<int>> d(a.size() + 1, std::vector<int>(b.size() + 1));
+    for (size_t i = 0; i <= a.size(); ++i) d[i][0] = static_cast<int>(i);
+    for (size_t j = 0; j <= b.size(); ++j) d[0][j] = static_cast<int>(j);
+    for (size_t i = 1; i <= a.size(); ++i) {
+        for (size_t j = 1; j <= b.size(); ++j) {
+            d[i][j] = std::min({d[i - 1][j] + 1, d[i][j - 1] + 1, d[i - 1][j - 1] + (a[i - 1] != b[j - 1])});
+            if (i > 1 && j > 1 && a[i - 1] == b[j - 2] && a[i - 2] == b[j - 1]) {
+                d[i][j] = std::min(d[i][j], d[i - 2][j - 2] + 1);
+            }
+        }
+    }
+    return d[a.size()][b.size()];
+}
+
+std::vector<std::string> randomWords(size_t count, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::vector<std::string> words;
+    for (size_t i = 0; i < count; ++i) {
+        std::string w(1 + rng() % 7, 'a');
+        for (char& c : w) c = static_cast<char>('a' + rng() % 5);
+        words.push_back(w);
+    }
+    return words;
+}
+} // namespace
+
+TEST(deletion_index_finds_words_two_edits_away) {
+    DeletionIndex index;
+    index.build({"spelling", "spilling", "selling", "smelling", "misspelling", "spell"});
+    std::atomic<bool> cancelled{false};
+
+    auto m = index.lookup("speling", 2, cancelled); // one omission
+    CHECK(!m.empty());
+    CHECK_EQ(std::string(m[0].word), std::string("spelling"));
+    CHECK_EQ(m[0].distance, 1);
+
+    m = index.lookup("SPELIGN", 2, cancelled); // omission + swap
+    CHECK(!m.empty());
+    CHECK_EQ(std::string(m[0].word), std::string("spelling"));
+    CHECK_EQ(m[0].distance, 2);
+
+    CHECK(index.lookup("speling", 0, cancelled).empty());
+    CHECK(index.lookup("zzzzzzz", 2, cancelled).empty());
+    CHECK(index.lookup("", 2, cancelled).empty());
+    CHECK(DeletionIndex().lookup("spell", 2, cancelled).empty());
+}
+
+TEST(deletion_index_matches_a_brute_force_scan) {
+    std::vector<std::string> words = randomWords(2000, 31);
+    DeletionIndex index;
+    index.build(words);
+    std::sort(words.begin(), words.end());
+    words.erase(std::unique(words.begin(), words.end()), words.end());
+    CHECK_EQ(index.size(), words.size());
+
+    std::atomic<bool> cancelled{false};
+    for (const std::string& probe : randomWords(200, 32)) {
+        std::vector<std::pair<int, std::string>> expected;
+        for (const std::string& w : words) {
+            int d = distance(probe, w);
+            if (d <= 2) expected.emplace_back(d, w);
+        }
+        std::sort(expected.begin(), expected.end());
+
+        auto got = index.lookup(probe, 2, cancelled);
+        bool same = got.size() == expected.size();
+        for (size_t i = 0; same && i < got.size(); ++i) {
+            same = got[i].distance == expected[i].first && got[i].word == expected[i].second;
+        }
+        if (!same) {
+            CHECK_EQ(probe, std::string("(a probe the index and the scan agree on)"));
+            break;
+        }
+    }
+}
+
+TEST(deletion_index_respects_cancellation) {
+    DeletionIndex index;
+    index.build(randomWords(2000, 41));
+    std::atomic<bool> cancelled{true};
+    CHECK(index.lookup("abcab", 2, cancelled).empty());
+}
+
+TEST(suggest_from_the_index_caps_and_capitalizes) {
+    DeletionIndex index;
+    index.build({"world", "word", "would", "wold", "cat", "cot", "cut", "coat", "cast", "colt", "cart", "chat", "act"});
+    std::atomic<bool> cancelled{false};
+
+    SuggestionResult r = suggest(index, "Wrold", cancelled);
+    CHECK(!r.correct);
+    CHECK(r.suggestions.size() >= 3);
+    if (r.suggestions.size() >= 3) {
+        // Distance 1, then distance 2; within each, the cheaper edits first.
+        CHECK_EQ(r.suggestions[0], std::string("Wold"));
+        CHECK_EQ(r.suggestions[1], std::string("World"));
+        CHECK_EQ(r.suggestions[2], std::string("Would"));
+    }
+
+    CHECK(suggest(index, "CAT", cancelled).correct);
+
+    r = suggest(index, "cqt", cancelled);
+    CHECK_EQ(r.suggestions.size(), static_cast<size_t>(8));
+    CHECK(!r.suggestions.empty() && r.suggestions[0] == "cat");
+}
@@ -1,8 +1,30 @@
+#include <atomic>
 #include <cstdio>
+#include <cstdlib>
 #include <fstream>
+#include <iterator>
+#include <new>
+#include <string>
+#include <string_view>
 
 #include "harness.h"
 #include "spell/Dictionary.h"
+#include "spell/Suggester.h"
+
+// Counts heap allocations made by the current thread, so tests can prove a
+// hot path allocates nothing. Replacing the global operator new applies to
+// the whole test binary; it only counts and forwards to malloc.
+namespace {
+thread_local long long allocations = 0;
+}
+
+void* operator new(std::size_t size) {
+    ++allocations;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
 
 using namespace editor;
 
@@ -30,3 +52,195 @@ TEST(dictionary_missing_file_is_harmless) {
     dict.loadFromFile("does_not_exist_hopefully.txt");
     CHECK_EQ(dict.size(), static_cast<size_t>(0));
 }
+
+TEST(dictionary_dedupes_and_reports_its_footprint) {
+    const char* path = "test_dictionary_tmp2.txt";
+    {
+        std::ofstream f(path);
+        for (int i = 0; i < 3000; ++i) f << "word" << i << "\n";
+        f << "Polish\npolish\n";
+    }
+    Dictionary dict;
+    dict.loadFromFile(path);
+    std::remove(path);
+    CHECK_EQ(dict.size(), static_cast<size_t>(3001));
+    CHECK(dict.contains("word0"));
+    CHECK(dict.contains("word2999"));
+    CHECK(dict.contains("POLISH"));
+    CHECK(!dict.contains("word3000"));
+    CHECK(!dict.contains("word"));   // prefix of stored words
+    CHECK(!dict.contains("word00")); // extension of a stored word
+    CHECK(!dict.contains(""));
+    CHECK(dict.bytesUsed() > 0);
+    CHECK(dict.bytesUsed() < 3001 * 32); // arena + 8-byte slots, not per-word nodes
+}
+
+TEST(dictionary_moves_with_its_contents) {
+    const char* path = "test_dictionary_tmp3.txt";
+    {
+        std::ofstream f(path);
+        f << "alpha\nbeta\n";
+    }
+    Dictionary loaded;
+    loaded.loadFromFile(path);
+    std::remove(path);
+    Dictionary moved = std::move(loaded);
+    CHECK(moved.contains("beta"));
+    CHECK_EQ(moved.size(), static_cast<size_t>(2));
+}
+
+TEST(contains_folds_case_without_allocating) {
+    const char* path = "test_dictionary_tmp4.txt";
+    {
+        std::ofstream f(path);
+        f << "Hello\nworld\nlonger-than-the-small-string-buffer\n";
+    }
+    Dictionary dict;
+    dict.loadFromFile(path);
+    std::remove(path);
+
+    const std::string line = "HeLLo WORLD LONGER-THAN-THE-SMALL-STRING-BUFFER nope";
+    std::string_view view(line);
+    long long before = allocations;
+    bool hits = dict.contains(view.substr(0, 5)) && dict.contains(view.substr(6, 5)) &&
+                dict.contains(view.substr(12, 35));
+    bool miss = dict.contains(view.substr(48)) || dict.contains("hell") || dict.contains("helloo");
+    long long made = allocations - before;
+    CHECK(hits);
+    CHECK(!miss);
+    CHECK_EQ(made, 0LL);
+}
+
+TEST(suggest_allocates_only_for_its_results) {
+    const char* path = "test_dictionary_tmp5.txt";
+    {
+        std::ofstream f(path);
+        f << "world\nword\nwould\n";
+    }
+    Dictionary dict;
+    dict.loadFromFile(path);
+    std::remove(path);
+
+    std::atomic<bool> cancelled{false};
+    long long before = allocations;
+    SuggestionResult r = suggest(dict, "wrold", cancelled);
+    long long made = allocations - before;
+    CHECK(!r.suggestions.empty());
+    // ~280 candidates are probed; what's left is the result vector and the
+    // copied hits, not one string per candidate.
+    CHECK(made < 16);
+}
+
+namespace {
+// Writes `words` to `txt` and builds `bin` from it, as tools/mkdict does.
+void buildBinary(const char* txt, const char* bin, const char* words) {
+    {
+        std::ofstream f(txt);
+        f << words;
+    }
+    Dictionary dict;
+    dict.loadFromFile(txt);
+    dict.writeBinary(bin, *Dictionary::stampOf(txt));
+}
+} // namespace
+
+TEST(binary_dictionary_round_trips) {
+    const char* txt = "test_dictionary_bin1.txt";
+    const char* bin = "test_dictionary_bin1.bin";
+    buildBinary(txt, bin, "Hello\nworld\nPolish\npolish\n");
+
+    Dictionary dict;
+    CHECK(dict.loadBinary(bin, Dictionary::stampOf(txt)));
+    CHECK(dict.mapped());
+    CHECK_EQ(dict.size(), static_cast<size_t>(3));
+    CHECK(dict.contains("HELLO"));
+    CHECK(dict.contains("world"));
+    CHECK(dict.contains("polish"));
+    CHECK(!dict.contains("hell"));
+    CHECK(!dict.contains("worlds"));
+
+    // Moving hands over the mapping; the moved-from dictionary is empty.
+    Dictionary moved = std::move(dict);
+    CHECK(moved.contains("hello"));
+    CHECK(!dict.contains("hello"));
+    CHECK_EQ(dict.size(), static_cast<size_t>(0));
+    std::remove(txt);
+    std::remove(bin);
+}
+
+TEST(load_prefers_a_current_binary_and_falls_back_when_stale) {
+    const char* txt = "test_dictionary_bin2.txt";
+    const char* bin = "test_dictionary_bin2.bin";
+    buildBinary(txt, bin, "alpha\nbeta\n");
+
+    Dictionary dict;
+    dict.load(txt, {"does_not_exist_hopefully.bin", bin});
+    CHECK(dict.mapped());
+    CHECK(dict.contains("beta"));
+
+    // Editing the word list makes the binary stale: its size no longer matches.
+    {
+        std::ofstream f(txt, std::ios::app);
+        f << "gamma\n";
+    }
+    Dictionary reloaded;
+    reloaded.load(txt, {bin});
+    CHECK(!reloaded.mapped());
+    CHECK(reloaded.contains("gamma"));
+    CHECK_EQ(reloaded.size(), static_cast<size_t>(3));
+
+    // With no word list at all, any valid binary will do.
+    std::remove(txt);
+    Dictionary binaryOnly;
+    binaryOnly.load(txt, {bin});
+    CHECK(binaryOnly.mapped());
+    CHECK(binaryOnly.contains("alpha"));
+    std::remove(bin);
+}
+
+TEST(corrupt_binary_dictionaries_are_rejected) {
+    const char* txt = "test_dictionary_bin3.txt";
+    const char* bin = "test_dictionary_bin3.bin";
+    buildBinary(txt, bin, "alpha\nbeta\n");
+    std::string good;
+    {
+        std::ifstream f(bin, std::ios::binary);
+        good.assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+    }
+    auto rejects = [&](std::string bytes) {
+        {
+            std::ofstream f(bin, std::ios::binary | std::ios::trunc);
+            f << bytes;
+        }
+        Dictionary dict;
+        return !dict.loadBinary(bin) && dict.size() == 0;
+    };
+    CHECK(!rejects(good));
+    CHECK(rejects(""));
+    CHECK(rejects(good.substr(0, 20)));                // truncated header
+    CHECK(rejects(good.substr(0, good.size() - 1)));   // truncated arena
+    CHECK(rejects(good + "x"));                        // trailing junk
+    std::string badMagic = good;
+    badMagic[0] = 'X';
+    CHECK(rejects(badMagic));
+    std::string badVersion = good;
+    badVersion[8] = 99;
+    CHECK(rejects(badVersion));
+    std::string noFinalNul = good;
+    noFinalNul.back() = 'x';
+    CHECK(rejects(noFinalNul));
+    std::string badOffset = good;
+    // First occupied slot's offset (slots start at byte 48) -> past the arena.
+    for (size_t i = 48; i + 8 <= badOffset.size(); i += 8) {
+        if (badOffset.compare(i, 4, "\xff\xff\xff\xff") != 0) {
+            badOffset.replace(i, 4, "\x00\x00\x01\x00", 4);
+            break;
+        }
+    }
+    CHECK(rejects(badOffset));
+
+    Dictionary stale;
+    CHECK(!stale.loadBinary(bin, Dictionary::SourceStamp{1, 2}));
+    std::remove(txt);
+    std::remove(bin);
+}
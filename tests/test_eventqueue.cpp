@@ -1,5 +1,9 @@
 #include <atomic>
 #include <future>
+#include <memory>
+#include <poll.h>
+#include <string>
+#include <thread>
 #include <vector>
 
 #include "concurrent/EventQueue.h"
@@ -47,3 +51,88 @@ TEST(drain_all_empties_the_queue) {
     CHECK_EQ(queue.drainAll().size(), static_cast<size_t>(2));
     CHECK_EQ(queue.drainAll().size(), static_cast<size_t>(0));
 }
+
+namespace {
+bool readable(int fd, int timeoutMs = 0) {
+    pollfd p{fd, POLLIN, 0};
+    return poll(&p, 1, timeoutMs) == 1;
+}
+} // namespace
+
+TEST(wake_fd_is_readable_only_while_events_are_queued) {
+    EventQueue queue;
+    CHECK(!readable(queue.wakeFd()));
+    queue.push(DictionaryLoadedEvent{1});
+    queue.push(DictionaryLoadedEvent{2});
+    CHECK(readable(queue.wakeFd()));
+    queue.drainAll();
+    CHECK(!readable(queue.wakeFd()));
+    queue.push(DictionaryLoadedEvent{3});
+    CHECK(readable(queue.wakeFd()));
+}
+
+TEST(push_from_worker_wakes_a_blocked_poll) {
+    EventQueue queue;
+    ThreadPool pool(1);
+    auto done = pool.submit([&queue] {
+        queue.push(DictionaryLoadedEvent{1});
+        return 0;
+    });
+    CHECK(readable(queue.wakeFd(), 5000));
+    done.get();
+    CHECK_EQ(queue.drainAll().size(), static_cast<size_t>(1));
+}
+
+TEST(drain_visits_events_in_push_order) {
+    EventQueue queue;
+    for (int i = 0; i < 5; ++i) queue.push(SuggestEvent{i, {}});
+    std::vector<int> seen;
+    size_t n = queue.drain([&seen](Event& e) { seen.push_back(std::get<SuggestEvent>(e).version); });
+    CHECK_EQ(n, static_cast<size_t>(5));
+    CHECK(seen == std::vector<int>({0, 1, 2, 3, 4}));
+    CHECK_EQ(queue.drain([](Event&) {}), static_cast<size_t>(0));
+}
+
+// Producers push while the consumer drains concurrently: every event must
+// arrive exactly once, each producer's events in order, and the wakeup fd
+// must never be left idle while events are queued. Run under TSan
+// (-DCMAKE_CXX_FLAGS=-fsanitize=thread) to check the memory ordering.
+TEST(concurrent_push_and_drain_delivers_everything_in_order) {
+    EventQueue queue;
+    const int producers = 4;
+    const int perProducer = 20000;
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&queue, p, perProducer] {
+            for (int i = 0; i < perProducer; ++i) queue.push(SuggestEvent{p * perProducer + i, {}});
+        });
+    }
+
+    std::vector<int> next(producers, 0);
+    int received = 0;
+    bool ordered = true;
+    while (received < producers * perProducer) {
+        // Blocking on the fd (with a generous cap) proves no wakeup is lost.
+        if (!readable(queue.wakeFd(), 5000)) break;
+        queue.drain([&](Event& e) {
+            int v = std::get<SuggestEvent>(e).version;
+            int p = v / perProducer;
+            if (v % perProducer != next[p]) ordered = false;
+            next[p] = v % perProducer + 1;
+            ++received;
+        });
+    }
+    for (auto& t : threads) t.join();
+    CHECK_EQ(received, producers * perProducer);
+    CHECK(ordered);
+    CHECK_EQ(queue.drainAll().size(), static_cast<size_t>(0));
+}
+
+TEST(undrained_events_are_freed_with_the_queue) {
+    EventQueue queue;
+    auto text = std::make_shared<std::string>("a\nb");
+    queue.push(LoadCompleteEvent{true, {std::shared_ptr<const char>(text, text->data()), text->size()}, "path", "", true});
+    queue.push(SuggestEvent{1, {}});
+    queue.drain([](Event&) {});
+    queue.push(SaveCompleteEvent{true, "path", ""});
+} // leak checkers (ASan) verify the destructor
@@ -1,9 +1,20 @@
 #include <cstdio>
+#include <cstdlib>
+#include <filesystem>
 #include <fstream>
+#include <future>
+#include <iterator>
 #include <sstream>
+#include <string>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
 
+#include "core/TextBuffer.h"
 #include "harness.h"
 #include "io/FileIO.h"
+#include "io/ParallelLoad.h"
 
 using namespace editor;
 
@@ -14,6 +25,29 @@ std::string readRaw(const char* path) {
     ss << f.rdbuf();
     return ss.str();
 }
+
+LoadResult loadOnPool(ThreadPool& pool, const std::string& path, size_t minRangeBytes) {
+    std::promise<LoadResult> promise;
+    std::future<LoadResult> result = promise.get_future();
+    loadFileParallel(pool, Lane::IO, path, [&promise](LoadResult r) { promise.set_value(std::move(r)); },
+                     minRangeBytes);
+    return result.get();
+}
+// Dies - as a crash or a kill would - after handing out `runs` byte runs.
+class DyingSnapshot : public LineVectorSnapshot {
+public:
+    DyingSnapshot(std::vector<std::string> lines, size_t runs) : LineVectorSnapshot(std::move(lines)), runs_(runs) {}
+    void forEachRun(const RunVisitor& visit) const override {
+        size_t runs = 0;
+        LineVectorSnapshot::forEachRun([&](std::string_view run) {
+            if (runs++ == runs_) std::_Exit(1);
+            visit(run);
+        });
+    }
+
+private:
+    size_t runs_;
+};
 } // namespace
 
 TEST(round_trip_preserves_trailing_newline) {
@@ -23,9 +57,9 @@ TEST(round_trip_preserves_trailing_newline) {
     LoadResult loaded = loadFile(path);
     CHECK(loaded.success);
     CHECK(loaded.trailingNewline);
-    CHECK_EQ(loaded.lines.size(), static_cast<size_t>(2));
+    CHECK_EQ(loaded.lines().size(), static_cast<size_t>(2));
 
-    saveFile(path, loaded.lines, loaded.trailingNewline);
+    saveFile(path, loaded.lines(), loaded.trailingNewline);
     CHECK_EQ(readRaw(path), std::string("a\nb\n"));
     std::remove(path);
 }
@@ -37,9 +71,9 @@ TEST(round_trip_preserves_missing_trailing_newline) {
     LoadResult loaded = loadFile(path);
     CHECK(loaded.success);
     CHECK(!loaded.trailingNewline);
-    CHECK_EQ(loaded.lines.size(), static_cast<size_t>(2));
+    CHECK_EQ(loaded.lines().size(), static_cast<size_t>(2));
 
-    saveFile(path, loaded.lines, loaded.trailingNewline);
+    saveFile(path, loaded.lines(), loaded.trailingNewline);
     CHECK_EQ(readRaw(path), std::string("a\nb"));
     std::remove(path);
 }
@@ -50,8 +84,8 @@ TEST(load_empty_file_yields_one_empty_line) {
 
     LoadResult loaded = loadFile(path);
     CHECK(loaded.success);
-    CHECK_EQ(loaded.lines.size(), static_cast<size_t>(1));
-    CHECK_EQ(loaded.lines[0], std::string(""));
+    CHECK_EQ(loaded.lines().size(), static_cast<size_t>(1));
+    CHECK_EQ(loaded.lines()[0], std::string(""));
     std::remove(path);
 }
 
@@ -59,3 +93,239 @@ TEST(load_missing_file_reports_failure) {
     LoadResult loaded = loadFile("definitely_missing_file_xyz.txt");
     CHECK(!loaded.success);
 }
+
+TEST(saving_over_a_loaded_file_leaves_the_document_intact) {
+    // The document reads straight from the file's mapping, so the save
+    // must replace the file rather than write into it.
+    const char* path = "test_fileio_tmp5.txt";
+    { std::ofstream f(path, std::ios::binary); f << "first\nsecond\n"; }
+
+    LoadResult loaded = loadFile(path);
+    CHECK(loaded.success);
+    TextBuffer buf;
+    buf.loadText(loaded.text);
+    CHECK_EQ(buf.lineCount(), 2);
+
+    SaveResult r = saveFile(path, std::vector<std::string>{"x"}, false);
+    CHECK(r.success);
+    CHECK_EQ(readRaw(path), std::string("x"));
+    CHECK_EQ(buf.line(0), std::string("first"));
+    CHECK_EQ(buf.line(1), std::string("second"));
+    std::remove(path);
+}
+
+TEST(save_from_snapshot_matches_vector_save) {
+    const char* path = "test_fileio_tmp4.txt";
+    TextBuffer buf;
+    buf.insertText({0, 0}, "one\ntwo\nthree");
+    SaveResult r = saveFile(path, *buf.snapshot(), true);
+    CHECK(r.success);
+    CHECK_EQ(readRaw(path), std::string("one\ntwo\nthree\n"));
+    std::remove(path);
+}
+
+TEST(saving_a_large_file_buffer_streams_its_edited_text) {
+    const char* path = "test_fileio_tmp6.txt";
+    std::string content;
+    for (int i = 0; i < 100000; ++i) content += "line " + std::to_string(i) + "\n";
+    { std::ofstream f(path, std::ios::binary); f << content; }
+
+    LoadResult loaded = loadFile(path);
+    CHECK(loaded.success);
+    TextBuffer buf(StorageKind::LargeFile);
+    buf.loadText(loaded.text);
+    buf.insertText({50000, 0}, "new ");
+    buf.eraseRange({0, 0}, {1, 0});
+
+    SaveResult r = saveFile(path, *buf.snapshot(), loaded.trailingNewline);
+    CHECK(r.success);
+    std::string expected = content.substr(content.find('\n') + 1);
+    expected.insert(expected.find("line 50000\n"), "new ");
+    CHECK(readRaw(path) == expected);
+    std::remove(path);
+}
+
+TEST(interrupted_save_leaves_the_original_intact) {
+    namespace fs = std::filesystem;
+    const fs::path dir = "test_fileio_dir1";
+    fs::remove_all(dir);
+    fs::create_directory(dir);
+    const std::string path = (dir / "doc.txt").string();
+    { std::ofstream f(path, std::ios::binary); f << "the original\n"; }
+
+    // Long lines go out as they come, so the save is well under way - and
+    // the temp file holds part of the new text - when it is cut off.
+    std::vector<std::string> lines;
+    for (int i = 0; i < 40; ++i) lines.push_back(i % 4 ? "short " + std::to_string(i) : std::string(300000, 'a' + i % 26));
+    for (size_t runs : {size_t(0), size_t(9), size_t(60)}) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            saveFile(path, DyingSnapshot(lines, runs), true);
+            std::_Exit(0); // not reached
+        }
+        int status = 0;
+        waitpid(pid, &status, 0);
+        CHECK(WIFEXITED(status) && WEXITSTATUS(status) == 1);
+        CHECK_EQ(readRaw(path.c_str()), std::string("the original\n"));
+    }
+
+    // Uninterrupted, the same text goes through whole.
+    SaveResult r = saveFile(path, LineVectorSnapshot(lines), true);
+    CHECK(r.success);
+    std::string expected;
+    for (const std::string& line : lines) expected += line + "\n";
+    CHECK(readRaw(path.c_str()) == expected);
+    CHECK_EQ(r.bytes, expected.size());
+    CHECK(r.megabytesPerSecond() > 0);
+    fs::remove_all(dir);
+}
+
+TEST(save_keeps_permissions_and_replaces_a_symlinks_target) {
+    namespace fs = std::filesystem;
+    const fs::path dir = "test_fileio_dir2";
+    fs::remove_all(dir);
+    fs::create_directory(dir);
+    const std::string target = (dir / "target.txt").string();
+    const std::string link = (dir / "link.txt").string();
+    { std::ofstream f(target, std::ios::binary); f << "old"; }
+    chmod(target.c_str(), 0640);
+    fs::create_symlink("target.txt", link);
+
+    CHECK(saveFile(link, std::vector<std::string>{"new"}, false).success);
+    CHECK(fs::is_symlink(link));
+    CHECK_EQ(readRaw(target.c_str()), std::string("new"));
+    struct stat st;
+    CHECK(stat(target.c_str(), &st) == 0 && (st.st_mode & 07777) == 0640);
+    // Nothing left behind but the two entries.
+    CHECK_EQ(std::distance(fs::directory_iterator(dir), fs::directory_iterator()), 2);
+    fs::remove_all(dir);
+}
+
+TEST(mapping_notices_in_place_changes_but_not_a_save) {
+    const char* path = "test_fileio_tmp9.txt";
+    { std::ofstream f(path, std::ios::binary); f << "one\ntwo\n"; }
+    LoadResult loaded = loadFile(path);
+    CHECK(loaded.mapping != nullptr);
+    CHECK(!loaded.mapping->changedOnDisk());
+
+    // A save renames a new file over the old one; the mapping keeps the old.
+    CHECK(saveFile(path, std::vector<std::string>{"three"}, true).success);
+    CHECK(!loaded.mapping->changedOnDisk());
+    CHECK_EQ(std::string(loaded.text.data.get(), loaded.text.size), std::string("one\ntwo"));
+
+    LoadResult again = loadFile(path);
+    MappedFile unwatched(path); // as the dictionary maps its file: no descriptor kept
+    { std::ofstream f(path, std::ios::binary | std::ios::trunc); f << "other"; }
+    CHECK(again.mapping->changedOnDisk());
+    CHECK(!unwatched.changedOnDisk());
+    std::remove(path);
+}
+
+TEST(document_stays_in_bounds_when_its_file_is_rewritten_in_place) {
+    const char* path = "test_fileio_tmp10.txt";
+    std::string content;
+    for (int i = 0; i < 5000; ++i) content += "line " + std::to_string(i) + "\n";
+    // Same size each time, so no page goes past the end of the file.
+    for (char fill : {'x', '\n'}) {
+        { std::ofstream f(path, std::ios::binary); f << content; }
+        LoadResult loaded = loadFile(path);
+        TextBuffer buf(StorageKind::LargeFile);
+        buf.loadText(loaded.text);
+        Row rows = buf.lineCount();
+        {
+            std::fstream f(path, std::ios::binary | std::ios::in | std::ios::out);
+            f << std::string(content.size(), fill);
+        }
+
+        size_t bytes = 0;
+        for (Row r = 0; r < rows; r += 97) bytes += buf.line(r).size() + static_cast<size_t>(buf.lineLength(r));
+        Row visited = 0;
+        buf.forEachLine(0, rows, [&](Row row, std::string_view text) {
+            visited += row >= 0 && row < rows;
+            bytes += text.size();
+        });
+        CHECK(visited <= rows);
+        CHECK(bytes <= 3 * content.size());
+        CHECK_EQ(buf.lineCount(), rows);
+    }
+    std::remove(path);
+}
+
+TEST(parallel_load_matches_serial_load) {
+    const char* path = "test_fileio_tmp7.txt";
+    ThreadPool pool(4, 3);
+    // Lines that straddle granule and range boundaries, long runs without
+    // a newline, and blank lines - ending with and without a newline.
+    std::string content;
+    for (int i = 0; i < 3000; ++i) {
+        content += std::string(static_cast<size_t>(i * 7 % 113), 'x') + (i % 50 == 0 ? "\n\n" : "\n");
+        if (i % 997 == 0) content += std::string(9000, 'y');
+    }
+    for (const std::string& text : {content, content + "tail", std::string("\n"), std::string("z")}) {
+        { std::ofstream f(path, std::ios::binary); f << text; }
+        LoadResult serial = loadFile(path);
+        for (size_t range : {size_t(1), size_t(4096), size_t(3 * 4096 + 1), size_t(1) << 20}) {
+            LoadResult parallel = loadOnPool(pool, path, range);
+            CHECK(parallel.success);
+            CHECK_EQ(parallel.trailingNewline, serial.trailingNewline);
+            CHECK_EQ(parallel.text.size, serial.text.size);
+            CHECK(parallel.text.newlines == serial.text.newlines);
+
+            TextBuffer a, b;
+            a.loadText(serial.text);
+            b.loadText(std::move(parallel.text));
+            CHECK_EQ(b.lineCount(), a.lineCount());
+            CHECK(b.lines() == a.lines());
+        }
+    }
+    std::remove(path);
+}
+
+TEST(streamed_load_arrives_in_order_and_matches_serial_load) {
+    const char* path = "test_fileio_tmp8.txt";
+    std::string content;
+    for (int i = 0; i < 20000; ++i) content += "line " + std::to_string(i) + (i % 3 ? " and more\n" : "\n");
+    { std::ofstream f(path, std::ios::binary); f << content; }
+    LoadResult serial = loadFile(path);
+    ThreadPool pool(4, 3);
+
+    for (size_t first : {size_t(1), size_t(5000), size_t(1) << 20}) {
+        std::promise<void> finished;
+        LoadResult opened;
+        size_t total = 0, delivered = 0;
+        TextBuffer buf;
+        bool inOrder = true;
+        streamFileParallel(
+            pool, Lane::IO, path,
+            [&](LoadResult r, size_t t) {
+                opened = r;
+                total = t;
+                delivered = r.text.size;
+                buf.loadText(std::move(r.text));
+                if (opened.text.size == total) finished.set_value();
+            },
+            [&](LoadChunk c) {
+                inOrder = inOrder && c.total == total && c.loaded == delivered + c.text.size;
+                delivered = c.loaded;
+                buf.appendText(std::move(c.text));
+                if (c.loaded == c.total) finished.set_value();
+            },
+            first, 4096);
+        finished.get_future().get();
+
+        CHECK(opened.success);
+        CHECK_EQ(opened.trailingNewline, serial.trailingNewline);
+        CHECK_EQ(total, serial.text.size);
+        CHECK(opened.text.size <= (first + 4095) / 4096 * 4096); // whole granules
+        CHECK(inOrder);
+        CHECK(buf.lines() == serial.lines());
+    }
+    std::remove(path);
+}
+
+TEST(parallel_load_reports_missing_file) {
+    ThreadPool pool(2);
+    LoadResult r = loadOnPool(pool, "definitely_missing_file_xyz.txt", kMinLoadRangeBytes);
+    CHECK(!r.success);
+    CHECK(!r.error.empty());
+}
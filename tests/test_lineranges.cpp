@@ -0,0 +1,75 @@
+#include "core/LineRanges.h"
+#include "core/TextBuffer.h"
+#include "harness.h"
+
+using namespace editor;
+
+TEST(range_set_merges_touching_ranges) {
+    LineRangeSet set;
+    set.add({5, 8});
+    set.add({1, 3});
+    set.add({3, 5});
+    CHECK_EQ(set.ranges().size(), static_cast<size_t>(1));
+    CHECK_EQ(set.ranges()[0].begin, 1);
+    CHECK_EQ(set.ranges()[0].end, 8);
+}
+
+TEST(range_set_remove_splits_a_range) {
+    LineRangeSet set;
+    set.add({0, 10});
+    set.remove({3, 5});
+    CHECK_EQ(set.ranges().size(), static_cast<size_t>(2));
+    CHECK(set.contains(2));
+    CHECK(!set.contains(3));
+    CHECK(!set.contains(4));
+    CHECK(set.contains(5));
+}
+
+TEST(range_set_shifts_rows_below_a_change) {
+    LineRangeSet set;
+    set.add({10, 12});
+    set.applyChange({2, 1, 3}); // a two-line paste on row 2
+    CHECK(set.contains(2));
+    CHECK(set.contains(4));
+    CHECK(!set.contains(10));
+    CHECK(set.contains(12));
+    CHECK(set.contains(13));
+    CHECK(!set.contains(14));
+}
+
+TEST(remap_drops_replaced_rows) {
+    Row row = 4;
+    CHECK(!remapRow(row, {3, 2, 1}));
+    row = 7;
+    CHECK(remapRow(row, {3, 2, 1}));
+    CHECK_EQ(row, 6);
+}
+
+TEST(text_buffer_reports_line_changes) {
+    TextBuffer buf;
+    buf.takeChanges();
+    buf.insertText({0, 0}, "a\nb\nc");
+    auto changes = buf.takeChanges();
+    CHECK_EQ(changes.size(), static_cast<size_t>(1));
+    CHECK_EQ(changes[0].row, 0);
+    CHECK_EQ(changes[0].removed, 1);
+    CHECK_EQ(changes[0].inserted, 3);
+
+    buf.eraseRange({0, 1}, {2, 0});
+    changes = buf.takeChanges();
+    CHECK_EQ(changes.size(), static_cast<size_t>(1));
+    CHECK_EQ(changes[0].removed, 3);
+    CHECK_EQ(changes[0].inserted, 1);
+    CHECK(buf.takeChanges().empty());
+}
+
+TEST(untaken_changes_collapse_to_whole_document) {
+    TextBuffer buf;
+    buf.takeChanges();
+    for (int i = 0; i < 5000; ++i) buf.insertText(buf.cursor(), i % 100 == 0 ? "\n" : "x");
+    auto changes = buf.takeChanges();
+    CHECK_EQ(changes.size(), static_cast<size_t>(1));
+    CHECK_EQ(changes[0].row, 0);
+    CHECK_EQ(changes[0].removed, 1);
+    CHECK_EQ(changes[0].inserted, buf.lineCount());
+}
@@ -0,0 +1,39 @@
+#include <random>
+#include <string>
+#include <vector>
+
+#include "core/Newlines.h"
+#include "harness.h"
+
+using namespace editor;
+
+TEST(count_newlines_matches_the_scalar_loop) {
+    // Long enough for the 255-round fold, at every alignment and ragged
+    // tail, with newlines dense, sparse and absent.
+    std::mt19937 rng(5);
+    for (int density : {0, 2, 50, 1000}) {
+        std::string text(20000, 'x');
+        if (density) {
+            for (char& c : text) {
+                if (rng() % density == 0) c = '\n';
+            }
+        }
+        for (size_t offset = 0; offset < 40; ++offset) {
+            size_t len = text.size() - offset - rng() % 40;
+            if (countNewlines(text.data() + offset, len) != countNewlinesScalar(text.data() + offset, len)) {
+                CHECK_EQ(countNewlines(text.data() + offset, len), countNewlinesScalar(text.data() + offset, len));
+                return;
+            }
+        }
+    }
+    std::string all(10000, '\n');
+    CHECK_EQ(countNewlines(all.data(), all.size()), all.size());
+    CHECK_EQ(countNewlines(all.data(), 0), static_cast<size_t>(0));
+}
+
+TEST(split_lines_cuts_at_every_newline) {
+    std::string text = "one\n\nthree\n";
+    CHECK(splitLines(text.data(), text.size()) == (std::vector<std::string>{"one", "", "three", ""}));
+    CHECK(splitLines(text.data(), 3) == std::vector<std::string>{"one"});
+    CHECK(splitLines(nullptr, 0) == std::vector<std::string>{""});
+}
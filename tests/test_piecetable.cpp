@@ -0,0 +1,234 @@
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+
+#include "core/LineVectorStorage.h"
+#include "core/PieceTable.h"
+#include "core/TextBuffer.h"
+#include "harness.h"
+
+using namespace editor;
+
+TEST(piece_table_starts_with_one_empty_line) {
+    PieceTable pt;
+    CHECK_EQ(pt.lineCount(), 1);
+    CHECK_EQ(pt.lineLength(0), 0);
+    CHECK_EQ(pt.line(0), std::string(""));
+}
+
+TEST(piece_table_load_and_read_lines) {
+    PieceTable pt;
+    pt.load({"alpha", "", "gamma"});
+    CHECK_EQ(pt.lineCount(), 3);
+    CHECK_EQ(pt.line(0), std::string("alpha"));
+    CHECK_EQ(pt.line(1), std::string(""));
+    CHECK_EQ(pt.line(2), std::string("gamma"));
+    CHECK_EQ(pt.lineLength(2), 5);
+}
+
+TEST(piece_table_load_text_points_into_the_block) {
+    auto block = std::make_shared<std::string>("alpha\n\ngamma");
+    PieceTable pt;
+    pt.loadText({std::shared_ptr<const char>(block, block->data()), block->size()});
+    CHECK_EQ(pt.lineCount(), 3);
+    CHECK_EQ(pt.line(2), std::string("gamma"));
+    CHECK(block.use_count() > 1); // shared, not copied
+
+    // Edits leave the block alone; snapshots keep it alive.
+    auto snap = pt.snapshot();
+    pt.insert({1, 0}, "beta");
+    CHECK_EQ(pt.line(1), std::string("beta"));
+    CHECK_EQ(snap->line(1), std::string(""));
+    CHECK_EQ(*block, std::string("alpha\n\ngamma"));
+}
+
+TEST(append_text_continues_the_last_line) {
+    auto block = std::make_shared<const std::string>("one\ntw" "o\nthree\n\nfour");
+    auto part = [&](size_t from, size_t to) {
+        return TextBlock{std::shared_ptr<const char>(block, block->data() + from), to - from};
+    };
+    for (StorageKind kind : {StorageKind::PieceTable, StorageKind::LineVector}) {
+        TextBuffer buf(kind);
+        buf.loadText(part(0, 6)); // "one\ntw"
+        buf.takeChanges();
+        auto snap = buf.snapshot();
+        buf.appendText(part(6, 14));
+        buf.appendText(part(14, 14));
+        buf.appendText(part(14, block->size()));
+
+        std::vector<std::string> expected{"one", "two", "three", "", "four"};
+        CHECK(buf.lines() == expected);
+        CHECK(!buf.modified());
+        CHECK_EQ(snap->lineCount(), 2); // taken before; unaffected
+        CHECK_EQ(snap->line(1), std::string("tw"));
+        // Each append replaces the last row and adds the rows after it.
+        auto changes = buf.takeChanges();
+        CHECK_EQ(changes.size(), static_cast<size_t>(3));
+        CHECK_EQ(changes[0].row, 1);
+        CHECK_EQ(changes[0].removed, 1);
+        CHECK_EQ(changes[0].inserted, 3);
+    }
+}
+
+TEST(large_file_storage_reads_and_edits_like_the_fine_grained_one) {
+    // Enough text for several of the large-file mode's pieces.
+    auto block = std::make_shared<std::string>();
+    for (int i = 0; i < 150000; ++i) *block += "row " + std::to_string(i) + (i % 7 ? " words\n" : "\n");
+    TextBlock text{std::shared_ptr<const char>(block, block->data()), block->size()};
+
+    TextBuffer fine(StorageKind::PieceTable), coarse(StorageKind::LargeFile);
+    fine.loadText(text);
+    coarse.loadText(text);
+    CHECK_EQ(coarse.lineCount(), fine.lineCount());
+    for (TextBuffer* buf : {&fine, &coarse}) {
+        buf->insertText({70000, 2}, "spliced\nin");
+        buf->eraseRange({120000, 1}, {120003, 0});
+    }
+    CHECK(coarse.lines() == fine.lines());
+
+    std::string joined;
+    coarse.snapshot()->forEachRun([&](std::string_view run) { joined += run; });
+    std::string expected;
+    for (const std::string& line : fine.lines()) expected += (expected.empty() ? "" : "\n") + line;
+    CHECK_EQ(joined.size(), expected.size());
+    CHECK(joined == expected);
+}
+
+TEST(piece_table_typing_extends_one_piece) {
+    PieceTable pt;
+    pt.load({"hello world"});
+    Position at{0, 5};
+    for (char c : std::string(",,,,")) {
+        pt.insert(at, std::string(1, c));
+        at.col++;
+    }
+    CHECK_EQ(pt.line(0), std::string("hello,,,, world"));
+    CHECK_EQ(pt.pieceCount(), static_cast<size_t>(3)); // "hello" + typed run + " world"
+}
+
+TEST(piece_table_erase_across_pieces_and_lines) {
+    PieceTable pt;
+    pt.load({"one", "two", "three"});
+    pt.insert({1, 1}, "XX\nYY");
+    CHECK_EQ(pt.lineCount(), 4);
+    CHECK_EQ(pt.text({0, 2}, {2, 3}), std::string("e\ntXX\nYYw"));
+    CHECK_EQ(pt.erase({0, 2}, {2, 3}), std::string("e\ntXX\nYYw"));
+    CHECK_EQ(pt.lineCount(), 2);
+    CHECK_EQ(pt.line(0), std::string("ono"));
+    CHECK_EQ(pt.line(1), std::string("three"));
+}
+
+TEST(piece_table_handles_lines_longer_than_a_piece) {
+    PieceTable pt;
+    std::string longLine(PieceTable::kMaxPieceBytes * 3 + 17, 'q');
+    pt.load({"head", longLine, "tail"});
+    CHECK_EQ(pt.lineLength(1), static_cast<int>(longLine.size()));
+    pt.insert({1, 5000}, "\n");
+    CHECK_EQ(pt.lineLength(1), 5000);
+    CHECK_EQ(pt.lineLength(2), static_cast<int>(longLine.size()) - 5000);
+    CHECK_EQ(pt.line(3), std::string("tail"));
+}
+
+TEST(piece_table_matches_line_vector_under_random_edits) {
+    PieceTable pt;
+    LineVectorStorage vec;
+    std::vector<std::string> initial;
+    for (int i = 0; i < 200; ++i) initial.push_back("line " + std::to_string(i) + std::string(i % 37, 'z'));
+    pt.load(initial);
+    vec.load(initial);
+
+    std::mt19937 rng(1234);
+    const std::string alphabet = "abc \n";
+    auto randomPos = [&](const TextStorage& s) {
+        int row = static_cast<int>(rng() % s.lineCount());
+        int col = static_cast<int>(rng() % (s.lineLength(row) + 1));
+        return Position{row, col};
+    };
+
+    bool same = true;
+    for (int step = 0; step < 3000 && same; ++step) {
+        if (rng() % 3 != 0) {
+            Position at = randomPos(vec);
+            std::string text;
+            int len = 1 + static_cast<int>(rng() % 6);
+            for (int i = 0; i < len; ++i) text += alphabet[rng() % alphabet.size()];
+            pt.insert(at, text);
+            vec.insert(at, text);
+        } else {
+            Position a = randomPos(vec), b = randomPos(vec);
+            if (b < a) std::swap(a, b);
+            same = pt.erase(a, b) == vec.erase(a, b);
+        }
+        same = same && pt.lineCount() == vec.lineCount();
+    }
+    CHECK(same);
+    for (int r = 0; r < vec.lineCount() && same; ++r) same = pt.line(r) == vec.line(r);
+    CHECK(same);
+}
+
+TEST(text_buffer_behaves_the_same_on_both_backends) {
+    for (StorageKind kind : {StorageKind::PieceTable, StorageKind::LineVector}) {
+        TextBuffer buf(kind);
+        buf.insertText({0, 0}, "foo\nbar");
+        buf.eraseRange({0, 2}, {1, 1});
+        CHECK_EQ(buf.lineCount(), 1);
+        CHECK_EQ(buf.line(0), std::string("foar"));
+        CHECK_EQ(buf.cursor().col, 2);
+    }
+}
+
+TEST(snapshot_is_unaffected_by_later_edits) {
+    PieceTable pt;
+    pt.load({"first", "second"});
+    auto snap = pt.snapshot();
+    pt.insert({0, 0}, "new\n");
+    pt.erase({2, 0}, {2, 3});
+    CHECK_EQ(pt.line(2), std::string("ond"));
+    CHECK_EQ(snap->lineCount(), 2);
+    CHECK_EQ(snap->line(0), std::string("first"));
+    CHECK_EQ(snap->line(1), std::string("second"));
+}
+
+TEST(snapshot_for_each_line_matches_line_lookup) {
+    PieceTable pt;
+    std::vector<std::string> initial;
+    for (int i = 0; i < 3000; ++i) initial.push_back(std::string(i % 50, 'a' + i % 26));
+    pt.load(initial);
+    pt.insert({100, 3}, "spliced\ntext");
+    auto snap = pt.snapshot();
+
+    std::vector<std::string> visited;
+    snap->forEachLine([&](Row row, std::string_view text) {
+        if (row == static_cast<Row>(visited.size())) visited.emplace_back(text);
+    });
+    CHECK_EQ(visited.size(), static_cast<size_t>(pt.lineCount()));
+    bool same = visited.size() == static_cast<size_t>(pt.lineCount());
+    for (int r = 0; r < pt.lineCount() && same; ++r) same = visited[r] == pt.line(r);
+    CHECK(same);
+
+    int count = 0;
+    snap->forEachLine(100, 102, [&](Row row, std::string_view text) {
+        CHECK_EQ(std::string(text), pt.line(row));
+        count++;
+    });
+    CHECK_EQ(count, 2);
+}
+
+TEST(snapshot_can_be_read_on_another_thread_during_edits) {
+    PieceTable pt;
+    std::vector<std::string> initial(2000, "the quick brown fox");
+    pt.load(initial);
+    auto snap = pt.snapshot();
+
+    size_t bytes = 0;
+    std::thread reader([&snap, &bytes] {
+        for (int pass = 0; pass < 5; ++pass) {
+            snap->forEachLine([&bytes](Row, std::string_view text) { bytes += text.size(); });
+        }
+    });
+    for (int i = 0; i < 2000; ++i) pt.insert({i % 50, 3}, i % 7 == 0 ? "\n" : "x");
+    reader.join();
+
+    CHECK_EQ(bytes, static_cast<size_t>(5 * 2000 * 19));
+}
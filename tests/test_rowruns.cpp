@@ -0,0 +1,43 @@
+#include "harness.h"
+#include "ui/RowRuns.h"
+
+using namespace editor;
+
+TEST(plain_row_is_a_single_run) {
+    MisspellingIndex none;
+    std::vector<StyleRun> runs;
+    buildRuns(0, 40, 0, 0, none.spans().begin(), none.spans().end(), runs);
+    CHECK_EQ(runs.size(), static_cast<size_t>(1));
+    CHECK_EQ(runs[0].colEnd, 40);
+    CHECK(runs[0].style == CellStyle::Normal);
+}
+
+TEST(misspelled_spans_split_the_row) {
+    MisspellingIndex index({{2, 4, 8}, {2, 10, 12}});
+    std::vector<StyleRun> runs;
+    buildRuns(2, 20, 0, 0, index.spans().begin(), index.spans().end(), runs);
+    CHECK_EQ(runs.size(), static_cast<size_t>(5));
+    CHECK_EQ(runs[1].colStart, 4);
+    CHECK_EQ(runs[1].colEnd, 8);
+    CHECK(runs[1].style == CellStyle::Misspelled);
+    CHECK_EQ(runs[4].colStart, 12);
+    CHECK(runs[4].style == CellStyle::Normal);
+}
+
+TEST(selection_wins_over_misspelling_and_runs_merge) {
+    MisspellingIndex index({{0, 2, 6}});
+    std::vector<StyleRun> runs;
+    buildRuns(0, 10, 1, 8, index.spans().begin(), index.spans().end(), runs);
+    CHECK_EQ(runs.size(), static_cast<size_t>(3));
+    CHECK_EQ(runs[1].colStart, 1);
+    CHECK_EQ(runs[1].colEnd, 8);
+    CHECK(runs[1].style == CellStyle::Selected);
+}
+
+TEST(spans_past_the_visible_width_are_clipped) {
+    MisspellingIndex index({{0, 6, 14}});
+    std::vector<StyleRun> runs;
+    buildRuns(0, 10, 0, 0, index.spans().begin(), index.spans().end(), runs);
+    CHECK_EQ(runs.size(), static_cast<size_t>(2));
+    CHECK_EQ(runs[1].colEnd, 10);
+}
@@ -0,0 +1,164 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "concurrent/Snapshot.h"
+#include "harness.h"
+#include "spell/MisspellingIndex.h"
+#include "spell/ParallelScan.h"
+#include "spell/SpellChecker.h"
+
+using namespace editor;
+
+namespace {
+Dictionary makeDict(const char* path) {
+    {
+        std::ofstream f(path);
+        f << "the\ncat\nsat\non\nmat\n";
+    }
+    Dictionary dict;
+    dict.loadFromFile(path);
+    std::remove(path);
+    return dict;
+}
+} // namespace
+
+TEST(scan_rows_only_visits_requested_rows) {
+    Dictionary dict = makeDict("test_spell_tmp1.txt");
+    auto snap = makeSnapshot({"teh cat", "the cat", "cat szt", "xx yy"});
+    std::atomic<bool> cancelled{false};
+    auto spans = scanRows(*snap, dict, {{0, 1}, {2, 3}}, cancelled);
+    CHECK_EQ(spans.size(), static_cast<size_t>(2));
+    CHECK_EQ(spans[0].row, 0);
+    CHECK_EQ(spans[0].colStart, 0);
+    CHECK_EQ(spans[1].row, 2);
+    CHECK_EQ(spans[1].colStart, 4);
+}
+
+TEST(scan_buffer_flags_every_row) {
+    Dictionary dict = makeDict("test_spell_tmp2.txt");
+    auto snap = makeSnapshot({"teh", "the", "szt"});
+    std::atomic<bool> cancelled{false};
+    CHECK_EQ(scanBuffer(*snap, dict, cancelled).size(), static_cast<size_t>(2));
+}
+
+TEST(cancelled_scan_returns_nothing) {
+    Dictionary dict = makeDict("test_spell_tmp3.txt");
+    auto snap = makeSnapshot({"teh", "szt"});
+    std::atomic<bool> cancelled{true};
+    CHECK(scanBuffer(*snap, dict, cancelled).empty());
+}
+
+TEST(scan_stops_promptly_once_cancelled) {
+    Dictionary dict = makeDict("test_spell_tmp4.txt");
+    std::vector<std::string> lines(400000, "teh cat sat on the mat with a quick brown fox jumping over");
+    auto snap = makeSnapshot(std::move(lines));
+    std::atomic<bool> cancelled{false};
+    std::chrono::steady_clock::time_point returned;
+    std::thread scanner([&] {
+        scanBuffer(*snap, dict, cancelled);
+        returned = std::chrono::steady_clock::now();
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    auto tripped = std::chrono::steady_clock::now();
+    cancelled = true;
+    scanner.join();
+    // A few ms of slack for scheduling and sanitizer builds; the check
+    // interval itself is well under a millisecond.
+    CHECK(returned - tripped < std::chrono::milliseconds(50));
+}
+
+TEST(chunk_rows_splits_ranges_into_equal_chunks) {
+    auto chunks = chunkRows({{0, 5}, {10, 12}, {20, 30}}, 4);
+    // 17 rows: [0,4) | [4,5) [10,12) [20,21) | [21,25) | [25,29) | [29,30)
+    CHECK_EQ(chunks.size(), static_cast<size_t>(5));
+    CHECK_EQ(chunks[1].size(), static_cast<size_t>(3));
+    CHECK_EQ(chunks[1][0].begin, 4);
+    CHECK_EQ(chunks[1][1].end, 12);
+    CHECK_EQ(chunks[1][2].end, 21);
+    CHECK_EQ(chunks[4][0].begin, 29);
+    CHECK_EQ(chunks[4][0].end, 30);
+}
+
+TEST(parallel_scan_matches_sequential_scan) {
+    Dictionary dict = makeDict("test_spell_tmp5.txt");
+    std::vector<std::string> lines;
+    for (int i = 0; i < 30000; ++i) lines.push_back(i % 7 ? "the cat sat" : "teh cat szt on the mta");
+    auto snap = makeSnapshot(std::move(lines));
+    std::vector<LineRange> rows = {{0, 9000}, {12000, 25000}, {29000, 40000}};
+    std::atomic<bool> never{false};
+    auto expected = scanRows(*snap, dict, rows, never);
+
+    ThreadPool pool(3);
+    std::promise<std::vector<MisspelledSpan>> result;
+    scanRowsParallel(pool, Lane::Background, snap, dict, rows, std::make_shared<std::atomic<bool>>(false),
+                     [&result](std::vector<MisspelledSpan> spans) { result.set_value(std::move(spans)); });
+    auto spans = result.get_future().get();
+    CHECK_EQ(spans.size(), expected.size());
+    bool same = spans.size() == expected.size();
+    for (size_t i = 0; same && i < spans.size(); ++i) {
+        same = spans[i].row == expected[i].row && spans[i].colStart == expected[i].colStart &&
+               spans[i].colEnd == expected[i].colEnd;
+    }
+    CHECK(same);
+}
+
+TEST(parallel_scan_reports_once_even_when_cancelled_or_empty) {
+    Dictionary dict = makeDict("test_spell_tmp6.txt");
+    auto snap = makeSnapshot(std::vector<std::string>(50000, "teh"));
+    ThreadPool pool(2);
+    std::atomic<int> calls{0};
+    {
+        std::promise<void> finished;
+        auto flag = std::make_shared<std::atomic<bool>>(true);
+        scanRowsParallel(pool, Lane::Background, snap, dict, {{0, 50000}}, flag,
+                         [&](std::vector<MisspelledSpan>) {
+                             calls++;
+                             finished.set_value();
+                         });
+        finished.get_future().get();
+    }
+    {
+        std::promise<size_t> found;
+        scanRowsParallel(pool, Lane::Background, snap, dict, {}, std::make_shared<std::atomic<bool>>(false),
+                         [&](std::vector<MisspelledSpan> spans) {
+                             calls++;
+                             found.set_value(spans.size());
+                         });
+        CHECK_EQ(found.get_future().get(), static_cast<size_t>(0));
+    }
+    CHECK_EQ(calls.load(), 2);
+}
+
+TEST(line_change_shifts_and_drops_spans) {
+    MisspellingIndex index({{1, 0, 3}, {4, 2, 5}, {9, 0, 1}});
+    index.applyLineChange({4, 1, 3}); // row 4 edited into three rows
+    CHECK_EQ(index.size(), static_cast<size_t>(2));
+    CHECK_EQ(index.spans()[0].row, 1);
+    CHECK_EQ(index.spans()[1].row, 11);
+}
+
+TEST(replace_rows_merges_a_delta_in_row_order) {
+    MisspellingIndex index({{1, 0, 3}, {4, 2, 5}, {9, 0, 1}});
+    index.replaceRows({{3, 6}}, MisspellingIndex({{3, 0, 2}, {5, 1, 2}}));
+    CHECK_EQ(index.size(), static_cast<size_t>(4));
+    CHECK_EQ(index.spans()[0].row, 1);
+    CHECK_EQ(index.spans()[1].row, 3);
+    CHECK_EQ(index.spans()[2].row, 5);
+    CHECK_EQ(index.spans()[3].row, 9);
+}
+
+TEST(index_returns_only_spans_in_the_requested_rows) {
+    MisspellingIndex index({{0, 0, 1}, {2, 0, 1}, {2, 4, 6}, {3, 1, 2}, {7, 0, 3}});
+    auto [begin, end] = index.rows(2, 4);
+    CHECK_EQ(end - begin, 3);
+    CHECK_EQ(begin->row, 2);
+    CHECK_EQ((end - 1)->row, 3);
+    auto [none, noneEnd] = index.rows(4, 7);
+    CHECK(none == noneEnd);
+}
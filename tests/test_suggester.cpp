@@ -1,6 +1,9 @@
 #include <atomic>
 #include <cstdio>
 #include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "harness.h"
 #include "spell/Dictionary.h"
@@ -65,3 +68,103 @@ TEST(suggest_single_letter_word_does_not_crash) {
     auto r = suggest(dict, "a", cancelled); // reversal loop must not run on a 1-char word
     CHECK(!r.correct);
 }
+
+namespace {
+Dictionary dictionaryOf(const char* path, const std::vector<std::string>& words) {
+    {
+        std::ofstream f(path);
+        for (const std::string& w : words) f << w << "\n";
+    }
+    Dictionary dict;
+    dict.loadFromFile(path);
+    std::remove(path);
+    return dict;
+}
+} // namespace
+
+TEST(word_frequencies_load_fold_case_and_add_up) {
+    const char* path = "test_suggest_freq.txt";
+    {
+        std::ofstream f(path);
+        f << "the 500\nThe 20\ncat 7 extra-column\nmalformed\n";
+    }
+    WordFrequencies freq;
+    CHECK(freq.loadFromFile(path));
+    std::remove(path);
+    CHECK_EQ(freq.size(), static_cast<size_t>(2));
+    CHECK_EQ(freq.count("THE"), 520u);
+    CHECK_EQ(freq.count("cat"), 7u);
+    CHECK_EQ(freq.count("ca"), 0u);
+    CHECK_EQ(freq.count("cats"), 0u);
+    CHECK(!WordFrequencies().loadFromFile("does_not_exist_hopefully.txt"));
+}
+
+TEST(suggestions_rank_by_frequency_within_a_distance) {
+    Dictionary dict = dictionaryOf("test_suggest_tmp3.txt", {"cat", "cot", "cut"});
+    WordFrequencies freq;
+    freq.build({{"cot", 100}, {"cut", 50}});
+    std::atomic<bool> cancelled{false};
+
+    SuggestionResult r = suggest(dict, "cxt", cancelled, &freq);
+    CHECK_EQ(r.suggestions.size(), static_cast<size_t>(3));
+    CHECK_EQ(r.scores.size(), r.suggestions.size());
+    if (r.suggestions.size() == 3) {
+        CHECK_EQ(r.suggestions[0], std::string("cot"));
+        CHECK_EQ(r.suggestions[1], std::string("cut"));
+        CHECK_EQ(r.suggestions[2], std::string("cat"));
+        CHECK_EQ(r.scores[0].frequency, 100u);
+        CHECK_EQ(r.scores[2].frequency, 0u);
+        CHECK_EQ(r.scores[0].distance, 1);
+    }
+}
+
+TEST(suggestions_rank_nearer_words_above_more_frequent_ones) {
+    DeletionIndex index;
+    index.build({"bat", "box"});
+    WordFrequencies freq;
+    freq.build({{"bat", 1}, {"box", 1000}});
+    std::atomic<bool> cancelled{false};
+
+    SuggestionResult r = suggest(index, "bxt", cancelled, &freq);
+    CHECK_EQ(r.suggestions.size(), static_cast<size_t>(2));
+    if (r.suggestions.size() == 2) {
+        CHECK_EQ(r.suggestions[0], std::string("bat")); // distance 1
+        CHECK_EQ(r.suggestions[1], std::string("box")); // distance 2, however common
+        CHECK_EQ(r.scores[1].distance, 2);
+    }
+}
+
+TEST(suggestions_prefer_neighbouring_keys_when_otherwise_tied) {
+    Dictionary dict = dictionaryOf("test_suggest_tmp4.txt", {"cat", "cot", "cut"});
+    std::atomic<bool> cancelled{false};
+
+    // 'o' and 'u' sit next to 'i'; 'a' is across the keyboard.
+    SuggestionResult r = suggest(dict, "cit", cancelled);
+    CHECK_EQ(r.suggestions.size(), static_cast<size_t>(3));
+    if (r.suggestions.size() == 3) {
+        CHECK_EQ(r.suggestions[0], std::string("cot"));
+        CHECK_EQ(r.suggestions[1], std::string("cut"));
+        CHECK_EQ(r.suggestions[2], std::string("cat"));
+        CHECK(r.scores[0].keyboardCost < r.scores[2].keyboardCost);
+    }
+}
+
+TEST(suggestions_keep_the_best_eight_of_many) {
+    // "xat" is one substitution from all 25 other "?at" words.
+    std::vector<std::string> words;
+    std::vector<std::pair<std::string, uint32_t>> counts;
+    for (char c = 'a'; c <= 'z'; ++c) {
+        if (c == 'x') continue;
+        words.push_back(std::string(1, c) + "at");
+        counts.emplace_back(words.back(), static_cast<uint32_t>(c - 'a'));
+    }
+    Dictionary dict = dictionaryOf("test_suggest_tmp5.txt", words);
+    WordFrequencies freq;
+    freq.build(counts);
+    std::atomic<bool> cancelled{false};
+
+    SuggestionResult r = suggest(dict, "xat", cancelled, &freq);
+    const char* expected[] = {"zat", "yat", "wat", "vat", "uat", "tat", "sat", "rat"};
+    CHECK_EQ(r.suggestions.size(), static_cast<size_t>(8));
+    for (size_t i = 0; i < r.suggestions.size() && i < 8; ++i) CHECK_EQ(r.suggestions[i], std::string(expected[i]));
+}
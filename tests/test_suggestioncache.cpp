@@ -0,0 +1,69 @@
+#include <string>
+#include <vector>
+
+#include "harness.h"
+#include "spell/SuggestionCache.h"
+
+using namespace editor;
+
+namespace {
+SuggestionResult resultFor(const std::string& word, std::vector<std::string> suggestions) {
+    SuggestionResult r;
+    r.word = word;
+    r.suggestions = std::move(suggestions);
+    return r;
+}
+} // namespace
+
+TEST(suggestion_cache_evicts_least_recently_used) {
+    SuggestionCache cache(2);
+    cache.put(resultFor("teh", {"the"}));
+    cache.put(resultFor("wrold", {"world"}));
+    CHECK(cache.get("teh").has_value()); // now "wrold" is the oldest
+    cache.put(resultFor("recieve", {"receive"}));
+
+    CHECK_EQ(cache.size(), static_cast<size_t>(2));
+    CHECK(cache.contains("teh"));
+    CHECK(!cache.contains("wrold"));
+    CHECK(cache.contains("recieve"));
+}
+
+TEST(suggestion_cache_counts_hits_and_misses) {
+    SuggestionCache cache;
+    cache.put(resultFor("teh", {"the"}));
+    CHECK(cache.get("teh").has_value());
+    CHECK(cache.get("TEH").has_value());
+    CHECK(!cache.get("wrold").has_value());
+    CHECK(cache.contains("wrold") == false); // contains() doesn't count
+    CHECK_EQ(cache.hits(), 2LL);
+    CHECK_EQ(cache.misses(), 1LL);
+}
+
+TEST(suggestion_cache_restyles_for_the_typed_word) {
+    SuggestionCache cache;
+    cache.put(resultFor("wrold", {"world", "wold"}));
+
+    auto r = cache.get("Wrold");
+    CHECK(r.has_value());
+    if (r) {
+        CHECK_EQ(r->word, std::string("Wrold"));
+        CHECK_EQ(r->suggestions.size(), static_cast<size_t>(2));
+        CHECK_EQ(r->suggestions[0], std::string("World"));
+        CHECK_EQ(r->suggestions[1], std::string("Wold"));
+    }
+    r = cache.get("wrold");
+    CHECK(r.has_value() && r->suggestions[0] == "world");
+}
+
+TEST(suggestion_cache_put_replaces_an_entry) {
+    SuggestionCache cache(2);
+    cache.put(resultFor("teh", {"ten"}));
+    cache.put(resultFor("wrold", {"world"}));
+    cache.put(resultFor("teh", {"the"})); // replaces, and makes it the newest
+    cache.put(resultFor("recieve", {"receive"}));
+
+    CHECK_EQ(cache.size(), static_cast<size_t>(2));
+    CHECK(!cache.contains("wrold"));
+    auto r = cache.get("teh");
+    CHECK(r.has_value() && r->suggestions.size() == 1 && r->suggestions[0] == "the");
+}
@@ -107,3 +107,16 @@ TEST(erase_range_order_independent) {
     std::string erased = buf.eraseRange({0, 3}, {0, 1}); // reversed on purpose
     CHECK_EQ(erased, std::string("el"));
 }
+
+TEST(for_each_line_visits_the_rows_asked_for_on_every_backend) {
+    for (StorageKind kind : {StorageKind::PieceTable, StorageKind::LineVector, StorageKind::LargeFile}) {
+        TextBuffer buf(kind);
+        buf.insertText({0, 0}, "zero\none\ntwo\nthree");
+        std::string seen;
+        buf.forEachLine(1, 3, [&](Row row, std::string_view text) { seen += std::to_string(row) + std::string(text); });
+        CHECK_EQ(seen, std::string("1one2two"));
+        seen.clear();
+        buf.forEachLine(3, 10, [&](Row row, std::string_view text) { seen += std::to_string(row) + std::string(text); });
+        CHECK_EQ(seen, std::string("3three")); // clipped to the buffer
+    }
+}
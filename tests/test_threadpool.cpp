@@ -0,0 +1,178 @@
+#include <atomic>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "concurrent/Task.h"
+#include "concurrent/ThreadPool.h"
+#include "concurrent/WorkStealingDeque.h"
+#include "harness.h"
+
+using namespace editor;
+
+TEST(task_holds_small_and_large_callables) {
+    int calls = 0;
+    Task small([&calls] { calls++; });
+    small();
+
+    char big[200] = {1};
+    Task large([&calls, big] { calls += big[0]; });
+    Task moved = std::move(large);
+    CHECK(!large);
+    moved();
+    CHECK_EQ(calls, 2);
+}
+
+TEST(task_accepts_move_only_callables) {
+    auto owned = std::make_unique<int>(7);
+    int seen = 0;
+    Task t([p = std::move(owned), &seen] { seen = *p; });
+    t();
+    CHECK_EQ(seen, 7);
+}
+
+TEST(deque_owner_pops_newest_and_thieves_take_oldest) {
+    WorkStealingDeque<int> dq(4);
+    int items[10];
+    for (int& i : items) dq.push(&i); // grows past the initial capacity
+    CHECK(dq.steal() == &items[0]);
+    CHECK(dq.pop() == &items[9]);
+    CHECK(dq.steal() == &items[1]);
+    int left = 0;
+    while (dq.pop()) left++;
+    CHECK_EQ(left, 7);
+    CHECK(dq.empty());
+    CHECK(dq.steal() == nullptr);
+}
+
+// The owner pushes and pops while thieves steal: every item must be taken
+// exactly once. Run under TSan to check the orderings.
+TEST(deque_hands_out_every_item_exactly_once_under_contention) {
+    const int count = 50000;
+    std::vector<int> items(count);
+    std::vector<std::atomic<int>> taken(count);
+    WorkStealingDeque<int> dq(8);
+    std::atomic<bool> done{false};
+    auto take = [&](int* p) { taken[p - items.data()].fetch_add(1); };
+
+    std::vector<std::thread> thieves;
+    for (int t = 0; t < 3; ++t) {
+        thieves.emplace_back([&] {
+            while (!done.load()) {
+                if (int* p = dq.steal()) take(p);
+            }
+        });
+    }
+    for (int i = 0; i < count; ++i) {
+        dq.push(&items[i]);
+        if (i % 3 == 0) {
+            if (int* p = dq.pop()) take(p);
+        }
+    }
+    while (int* p = dq.pop()) take(p);
+    done = true;
+    for (auto& t : thieves) t.join();
+    while (int* p = dq.steal()) take(p);
+
+    bool exactlyOnce = true;
+    for (auto& t : taken) exactlyOnce = exactlyOnce && t.load() == 1;
+    CHECK(exactlyOnce);
+}
+
+TEST(threadpool_post_runs_nested_tasks_on_workers) {
+    std::atomic<int> counter{0};
+    {
+        ThreadPool pool(3);
+        for (int i = 0; i < 20; ++i) {
+            pool.post([&pool, &counter] {
+                for (int j = 0; j < 50; ++j) pool.post([&counter] { counter++; });
+            });
+        }
+    } // destructor finishes everything, including tasks posted by tasks
+    CHECK_EQ(counter.load(), 20 * 50);
+}
+
+TEST(threadpool_submit_returns_values_and_exceptions) {
+    ThreadPool pool(2);
+    auto value = pool.submit([] { return 42; });
+    auto nothing = pool.submit([] {});
+    auto failure = pool.submit([]() -> int { throw std::runtime_error("boom"); });
+    CHECK_EQ(value.get(), 42);
+    nothing.get();
+    bool threw = false;
+    try {
+        failure.get();
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    CHECK(threw);
+}
+
+TEST(threadpool_survives_throwing_posted_task) {
+    ThreadPool pool(1);
+    pool.post([] { throw std::runtime_error("ignored"); });
+    CHECK_EQ(pool.submit([] { return 1; }).get(), 1);
+}
+
+TEST(threadpool_wakes_sleeping_workers_for_late_work) {
+    ThreadPool pool(2);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20)); // let workers go idle
+    std::atomic<int> counter{0};
+    std::vector<std::future<void>> futures;
+    for (int i = 0; i < 100; ++i) futures.push_back(pool.submit([&counter] { counter++; }));
+    for (auto& f : futures) f.get();
+    CHECK_EQ(counter.load(), 100);
+}
+
+TEST(threadpool_interactive_task_jumps_queued_bulk_work) {
+    ThreadPool pool(2); // one bulk worker, one kept free
+    std::atomic<int> bulkDone{0};
+    for (int i = 0; i < 10; ++i) {
+        pool.post(Lane::Background, [&bulkDone] {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            bulkDone++;
+        });
+    }
+    int doneWhenServed = pool.submit(Lane::Interactive, [&bulkDone] { return bulkDone.load(); }).get();
+    CHECK(doneWhenServed < 3);
+}
+
+TEST(threadpool_caps_concurrent_bulk_workers) {
+    std::atomic<int> running{0};
+    std::atomic<int> peak{0};
+    {
+        ThreadPool pool(4, 2);
+        CHECK_EQ(pool.bulkWorkerLimit(), static_cast<size_t>(2));
+        for (int i = 0; i < 20; ++i) {
+            pool.post(i % 2 ? Lane::IO : Lane::Background, [&running, &peak] {
+                int now = ++running;
+                int prev = peak.load();
+                while (now > prev && !peak.compare_exchange_weak(prev, now)) {
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(2));
+                running--;
+            });
+        }
+    }
+    CHECK(peak.load() <= 2);
+    CHECK(peak.load() >= 1);
+}
+
+TEST(threadpool_reports_per_lane_stats) {
+    ThreadPool pool(2);
+    std::vector<std::future<void>> futures;
+    for (int i = 0; i < 5; ++i) futures.push_back(pool.submit(Lane::IO, [] {}));
+    futures.push_back(pool.submit(Lane::Interactive, [] {}));
+    for (auto& f : futures) f.get();
+
+    // The future is ready just before the task is counted as completed.
+    while (pool.laneStats(Lane::IO).completed < 5) std::this_thread::yield();
+    LaneStats io = pool.laneStats(Lane::IO);
+    CHECK_EQ(io.queued, static_cast<int64_t>(0));
+    CHECK_EQ(io.started, static_cast<uint64_t>(5));
+    CHECK(io.maxWaitMs >= 0 && io.totalWaitMs >= io.maxWaitMs);
+    CHECK_EQ(pool.laneStats(Lane::Interactive).started, static_cast<uint64_t>(1));
+    CHECK_EQ(pool.laneStats(Lane::Background).started, static_cast<uint64_t>(0));
+}
@@ -1,3 +1,7 @@
+#include <memory>
+#include <string>
+#include <vector>
+
 #include "core/Document.h"
 #include "harness.h"
 
@@ -78,3 +82,44 @@ TEST(cut_and_paste_round_trip) {
     doc.pasteFrom(clip);
     CHECK_EQ(doc.buffer().lines()[0], std::string("cab"));
 }
+
+TEST(find_next_wraps_around_to_the_cursor) {
+    Document doc;
+    doc.loadLines({"Alpha beta", "gamma", "alpha"});
+    doc.buffer().setCursor({1, 0});
+    CHECK(doc.findNext("alpha", true));
+    CHECK_EQ(doc.buffer().cursor().row, 2);
+    CHECK(doc.findNext("ALPHA", false)); // wraps to the first row
+    CHECK_EQ(doc.selectionRange().first.row, 0);
+    CHECK_EQ(doc.selectionRange().first.col, 0);
+    CHECK(!doc.findNext("delta", false));
+}
+
+TEST(replace_all_on_a_large_file_matches_the_line_vector) {
+    // Enough rows for several of large-file mode's pieces; several matches
+    // on some rows, and a replacement that splits rows.
+    auto block = std::make_shared<std::string>();
+    for (int i = 0; i < 60000; ++i) *block += (i % 1000 ? "row " : "Cat and cat: row ") + std::to_string(i) + "\n";
+    for (const std::string replacement : {"dog", "a\nb"}) {
+        Document large, small;
+        large.loadText({std::shared_ptr<const char>(block, block->data()), block->size()}, StorageKind::LargeFile);
+        small.loadText({std::shared_ptr<const char>(block, block->data()), block->size()}, StorageKind::LineVector);
+        CHECK_EQ(large.replaceAll("cat", replacement, false), 120);
+        CHECK_EQ(small.replaceAll("cat", replacement, false), 120);
+        CHECK(large.buffer().lines() == small.buffer().lines());
+        CHECK_EQ(large.buffer().line(0), replacement == "dog" ? std::string("dog and dog: row 0") : std::string("a"));
+        CHECK_EQ(large.buffer().cursor().row, small.buffer().cursor().row);
+        CHECK_EQ(large.buffer().cursor().col, small.buffer().cursor().col);
+    }
+}
+
+TEST(replace_all_is_undone_a_replacement_at_a_time) {
+    Document doc;
+    doc.loadLines({"aXbXc", "X"});
+    CHECK_EQ(doc.replaceAll("x", "yy", false), 3);
+    CHECK_EQ(doc.buffer().line(0), std::string("ayybyyc"));
+    CHECK_EQ(doc.buffer().line(1), std::string("yy"));
+    while (doc.undo()) {}
+    CHECK_EQ(doc.buffer().line(0), std::string("aXbXc"));
+    CHECK_EQ(doc.buffer().line(1), std::string("X"));
+}
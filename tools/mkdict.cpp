@@ -0,0 +1,34 @@
+#include <cstdio>
+#include <optional>
+#include <string>
+
+#include "spell/Dictionary.h"
+
+// Builds dictionary.bin - the prebuilt table and arena the editor maps at
+// startup - from a whitespace-separated word list. The build runs it on
+// dictionary.txt; rerun it by hand after editing the word list, or the
+// editor will notice the binary is stale and fall back to parsing.
+//
+// Usage: mkdict <dictionary.txt> <dictionary.bin>
+
+using namespace editor;
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        std::fprintf(stderr, "usage: %s <dictionary.txt> <dictionary.bin>\n", argv[0]);
+        return 2;
+    }
+    std::optional<Dictionary::SourceStamp> source = Dictionary::stampOf(argv[1]);
+    if (!source) {
+        std::fprintf(stderr, "mkdict: cannot read '%s'\n", argv[1]);
+        return 1;
+    }
+    Dictionary dict;
+    dict.loadFromFile(argv[1]);
+    if (dict.size() == 0 || !dict.writeBinary(argv[2], *source)) {
+        std::fprintf(stderr, "mkdict: failed to write '%s'\n", argv[2]);
+        return 1;
+    }
+    std::printf("mkdict: %zu words, %zu KiB -> %s\n", dict.size(), dict.bytesUsed() / 1024, argv[2]);
+    return 0;
+}